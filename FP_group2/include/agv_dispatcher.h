@@ -0,0 +1,67 @@
+#ifndef AGV_DISPATCHER_H
+#define AGV_DISPATCHER_H
+
+#include <array>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include <ros/ros.h>
+#include <std_msgs/String.h>
+
+const int NUMBER_OF_AGVS = 2;
+const double AGV_SERVICE_TIMEOUT = 5.0; // s, waiting for /ariac/agvN once at startup
+
+/**
+ * @brief Sends AGVs to deliver their shipments without stopping the gantry.
+ * Service clients are created once and kept connected, submissions are
+ * made in order by a worker thread and completed through a future. The AGV
+ * state topics tell when a tray can be loaded again.
+ */
+class AgvDispatcher
+{
+public:
+    explicit AgvDispatcher(ros::NodeHandle &node);
+    ~AgvDispatcher();
+    void init();
+
+    std::shared_future<bool> submit(int agv_id, const std::string &shipment_type);
+    bool available(int agv_id) const;
+    std::string state(int agv_id) const;
+    void waitAll();
+    void printReport() const;
+
+    void agv_state_callback(const std_msgs::String::ConstPtr &msg, int agv_id);
+
+private:
+    typedef struct Submission {
+        int agv_id;
+        std::string shipment_type;
+        std::shared_ptr<std::promise<bool>> done;
+        ros::WallTime queued;
+    } submission;
+
+    void worker();
+    ros::ServiceClient & client(int agv_id);
+
+    ros::NodeHandle node_;
+    std::array<ros::ServiceClient, NUMBER_OF_AGVS> clients_;
+    std::array<ros::Subscriber, NUMBER_OF_AGVS> state_subscribers_;
+    std::array<std::string, NUMBER_OF_AGVS> states_; // last /ariac/agvN/state, empty until heard
+    std::array<bool, NUMBER_OF_AGVS> in_flight_; // submitted, not back to ready_to_deliver yet
+
+    mutable std::mutex mutex_;
+    std::condition_variable wake_, idle_;
+    std::deque<Submission> queue_;
+    bool busy_, stopping_;
+    std::thread worker_;
+
+    int submitted_, failed_;
+    double latency_; // s, queued -> service response, summed
+};
+
+#endif
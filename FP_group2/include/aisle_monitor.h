@@ -0,0 +1,64 @@
+#ifndef AISLE_MONITOR_H
+#define AISLE_MONITOR_H
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "aisle_predictor.h"
+#include "breakbeam_monitor.h"
+
+const double AISLE_MONITOR_PERIOD = 0.5; // s, re-evaluation of the predictions between beam edges
+
+enum AisleOccupancy { AISLE_CLEAR, AISLE_OCCUPIED };
+
+/**
+ * @brief What the monitor knows about one aisle.
+ */
+typedef struct AisleState {
+    AisleOccupancy occupancy;
+    double clear_at; // s, start of the next window long enough for a pick, infinite if none is predicted
+} aisle_state;
+
+/**
+ * @brief Keeps the state of every aisle up to date in a background thread,
+ * from the breakbeam edges and the AislePredictor, and reports changes.
+ * Readers only copy the current table, they never wait for the thread.
+ */
+class AisleMonitor
+{
+public:
+    typedef std::function<void(int aisle, const AisleState &state)> ChangeCallback;
+
+    AisleMonitor(BreakbeamMonitor &breakbeams, AislePredictor &predictor);
+    ~AisleMonitor();
+
+    void start(const std::array<int, NUMBER_OF_AISLES> &residents);
+    void stop();
+    void onChange(const ChangeCallback &callback);
+
+    AisleState state(int aisle) const;
+    std::array<int, NUMBER_OF_AISLES> blocked(double now) const;
+
+private:
+    void run();
+    void refresh(double now);
+
+    BreakbeamMonitor &breakbeams_;
+    AislePredictor &predictor_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable edge_;
+    bool edged_;
+    std::array<AisleState, NUMBER_OF_AISLES> states_;
+    std::array<int, NUMBER_OF_AISLES> residents_; // people seen at startup, Competition::humans()
+    std::vector<ChangeCallback> callbacks_;
+    std::atomic<bool> running_;
+    std::thread thread_;
+};
+
+#endif
@@ -0,0 +1,62 @@
+#ifndef AISLE_PREDICTOR_H
+#define AISLE_PREDICTOR_H
+
+#include <array>
+#include <mutex>
+#include <vector>
+
+const int NUMBER_OF_AISLES = 4;
+const double AISLE_SWEEP_GAP = 4.0; // s, beam edges closer than this belong to the same walk along the aisle
+const double AISLE_CLEAR_MARGIN = 1.5; // s, kept free before and after each predicted walk
+const double AISLE_PICK_TIME = 6.0; // s, gantry stopped in the aisle for one pick
+const double AISLE_MAX_WAIT = 20.0; // s, longest wait at the aisle entry, HUMAN_AISLE_PENALTY in the ranking
+
+/**
+ * @brief Time interval the aisle is free of a walking person. end is
+ * infinite when nobody walks there.
+ */
+typedef struct ClearWindow {
+    bool feasible; // a window of the requested length exists
+    double start, end; // s
+} clear_window;
+
+/**
+ * @brief Forecasts the people walking up and down the aisles.
+ *
+ * A person walks the aisle for move_time, waits wait_time at the end and
+ * comes back (the aisle_layout of the trial), so walks start every
+ * move_time + wait_time. The model comes from ~aisle_layout when it is
+ * given; the breakbeams along the aisle correct its phase, and estimate
+ * period and walk length when it is not given. The aisle counts as
+ * occupied only while the person walks.
+ */
+class AislePredictor
+{
+public:
+    AislePredictor();
+
+    void configure(int aisle, double start_time, double move_time, double wait_time);
+    void observe(int beam, bool rising, double time);
+
+    bool known(int aisle) const;
+    bool predictable(int aisle) const;
+    bool occupied(int aisle, double time) const;
+    ClearWindow nextClear(int aisle, double time, double duration) const;
+
+    static int aisleOfBeam(int beam);
+    static int aisleAt(double y);
+
+private:
+    typedef struct PersonModel {
+        bool configured = false;
+        double start_time = 0.0, move_time = 0.0, wait_time = 0.0;
+        std::vector<std::pair<double, double>> sweeps; // observed walks, first and last beam edge
+    } person_model;
+
+    bool estimate(const PersonModel &person, double &anchor, double &half_period, double &move) const;
+
+    mutable std::mutex mutex_;
+    std::array<PersonModel, NUMBER_OF_AISLES> people_;
+};
+
+#endif
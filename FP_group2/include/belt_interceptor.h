@@ -0,0 +1,70 @@
+#ifndef BELT_INTERCEPTOR_H
+#define BELT_INTERCEPTOR_H
+
+#include <string>
+
+#include "part_selector.h"
+
+// Conveyor, world frame; parts pass logical camera 12 before the grasp stations
+const double BELT_DIRECTION_Y = -1.0; // sign of the part velocity along y
+const double BELT_GRASP_OFFSET_Y = 0.0; // m, grasp point relative to the gantry y of a belt preset
+const double BELT_STATION_SETTLE_TIME = 1.5; // s, arm reconfiguration on top of the gantry travel
+const double BELT_GRASP_LEAD = 0.5; // s, gripper turned on before the part arrives
+const double BELT_GRASP_WINDOW = 1.5; // s, part still under the gripper after its predicted arrival
+const double BELT_INTERCEPT_MARGIN = 0.5; // s, gantry must be in place this long before the grasp
+const double DIRECT_PLACE_WINDOW = 12.0; // s, longest belt -> AGV move for placing a belt part without staging
+const double BELT_WAIT_TIMEOUT = 30.0; // s, longest wait for a belt part when nothing else can be done
+const double BELT_LAST_GRASP_Y = -3.0; // world y, lowest grasp point, parts fall off at -4.3
+const double BELT_INTERCEPT_STEP = 0.05; // m, downstream search step for a reachable grasp point
+const double BELT_BEAM_TO_CAMERA_TIME = 7.0; // s, breakbeam 0 (y 3.32) to logical camera 12 (y 1.94) at 0.2 m/s
+
+/**
+ * @brief Where and when a part was last seen on the belt.
+ */
+typedef struct BeltSighting {
+    std::string type;
+    double y; // world
+    double time; // s
+} belt_sighting;
+
+/**
+ * @brief Predicted meeting of a belt part and a grasp station.
+ */
+typedef struct Intercept {
+    bool feasible; // gantry can be in place before the grasp
+    double y; // world y of the grasp point
+    double arrival_time; // part under the gripper
+    double grasp_time; // turn the gripper on
+    double slack; // s, gantry idle time at the station
+} intercept;
+
+/**
+ * @brief Predicts belt parts from one camera sighting and the belt speed, so
+ * the gantry goes straight to where a part will be instead of waiting for
+ * it at the belt. A part the gantry cannot meet at its preset is met further
+ * downstream.
+ */
+class BeltInterceptor
+{
+public:
+    explicit BeltInterceptor(double speed);
+
+    double positionAt(const BeltSighting &sighting, double time) const;
+    Intercept plan(const BeltSighting &sighting, point2 station, double now, point2 gantry) const;
+    bool isNew(const BeltSighting &sighting) const { return sighting.time > last_grasp_time_; }
+    void record(const BeltSighting &sighting, const Intercept &intercept, bool grasped);
+
+    int grasps() const { return grasps_; }
+    int misses() const { return misses_; }
+    double slack() const { return slack_; } // s, summed over successful grasps
+
+private:
+    Intercept meet(const BeltSighting &sighting, double y, double now, double travel_time) const;
+
+    double speed_;
+    double last_grasp_time_;
+    int grasps_, misses_;
+    double slack_;
+};
+
+#endif
@@ -0,0 +1,50 @@
+#ifndef BREAKBEAM_MONITOR_H
+#define BREAKBEAM_MONITOR_H
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+#include <ros/time.h>
+
+#include "breakbeam_store.h"
+
+const int BELT_BREAKBEAM = 0; // on the belt, upstream of logical camera 12
+const double BREAKBEAM_WAIT_TIMEOUT = 60.0; // s, longest wait for a person to leave a beam
+
+/**
+ * @brief Edges of the breakbeam sensors, fed by Competition::breakbeam_sensor_callback.
+ * State lives in a BreakbeamStore, so reads never lock. Waiting threads
+ * sleep on a condition variable until the edge they want arrives,
+ * callbacks run on the ROS spinner thread for every edge.
+ */
+class BreakbeamMonitor
+{
+public:
+    typedef std::function<void(int beam, bool rising, ros::Time stamp)> EdgeCallback;
+
+    BreakbeamMonitor();
+
+    void update(int beam, bool detected, uint32_t sequence, ros::Time stamp);
+    void onEdge(const EdgeCallback &callback);
+
+    bool waitForEdge(int beam, BeamEdge edge, double timeout);
+    int waitForAny(const std::vector<int> &beams, BeamEdge edge, double timeout);
+    bool waitWhileDetected(int beam, double timeout);
+
+    bool detected(int beam) const { return store_.detected(beam); }
+    uint32_t sequence(int beam) const { return store_.sequence(beam); }
+    ros::Time lastRising(int beam) const;
+    ros::Time lastFalling(int beam) const;
+    int edges(int beam) const { return store_.edges(beam, BEAM_ANY); }
+    BeamSnapshot snapshot() const { return store_.snapshot(); }
+
+private:
+    BreakbeamStore store_;
+    std::mutex mutex_; // only for the waiters and the callback list
+    std::condition_variable changed_;
+    std::vector<EdgeCallback> callbacks_;
+};
+
+#endif
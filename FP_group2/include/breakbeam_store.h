@@ -0,0 +1,57 @@
+#ifndef BREAKBEAM_STORE_H
+#define BREAKBEAM_STORE_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+const int NUMBER_OF_BREAKBEAMS = 29; // /ariac/breakbeam_0..28
+
+enum BeamEdge { BEAM_RISING, BEAM_FALLING, BEAM_ANY };
+
+/**
+ * @brief Every beam at one instant, copied out of BreakbeamStore.
+ */
+typedef struct BeamSnapshot {
+    uint32_t states; // bit b set: something in beam b
+    std::array<uint32_t, NUMBER_OF_BREAKBEAMS> sequence; // header.seq of the last message
+    std::array<uint32_t, NUMBER_OF_BREAKBEAMS> rising, falling; // edges so far
+    std::array<uint64_t, NUMBER_OF_BREAKBEAMS> last_rising, last_falling; // ns, message stamps
+    uint64_t version; // even, grows with every update
+
+    bool detected(int beam) const { return beam >= 0 && beam < NUMBER_OF_BREAKBEAMS && (states >> beam & 1u); }
+} beam_snapshot;
+
+/**
+ * @brief Breakbeam state written by the sensor callbacks (any spinner
+ * thread) and read by the executive without locks.
+ *
+ * Every field is an atomic, so single values can be read directly. A
+ * seqlock version around each update lets snapshot() copy all beams
+ * consistently: readers retry instead of blocking writers. Writers
+ * serialize on a spin flag held for a handful of stores.
+ */
+class BreakbeamStore
+{
+public:
+    BreakbeamStore();
+
+    int update(int beam, bool detected, uint32_t sequence, uint64_t stamp);
+
+    bool detected(int beam) const;
+    uint32_t states() const { return states_.load(std::memory_order_acquire); }
+    uint32_t sequence(int beam) const;
+    uint32_t edges(int beam, BeamEdge edge) const;
+    uint64_t lastRising(int beam) const;
+    uint64_t lastFalling(int beam) const;
+    BeamSnapshot snapshot() const;
+
+private:
+    std::atomic_flag writing_ = ATOMIC_FLAG_INIT;
+    std::atomic<uint64_t> version_;
+    std::atomic<uint32_t> states_;
+    std::array<std::atomic<uint32_t>, NUMBER_OF_BREAKBEAMS> sequence_, rising_, falling_;
+    std::array<std::atomic<uint64_t>, NUMBER_OF_BREAKBEAMS> last_rising_, last_falling_;
+};
+
+#endif
@@ -1,6 +1,7 @@
 #ifndef COMPETITION_H
 #define COMPETITION_H
 
+#include <atomic>
 #include <vector>
 
 #include <ros/ros.h>
@@ -24,6 +25,10 @@
 #include <vector>
 #include <stdio.h>
 #include "utils.h"
+#include "order_book.h"
+#include "breakbeam_monitor.h"
+#include "frame_table.h"
+#include "qc_registry.h"
 
 
 /**
@@ -46,27 +51,24 @@ public:
     void logical_camera_callback(const nist_gear::LogicalCameraImage::ConstPtr &msg, int id);
     void quality_sensor_status_callback(const nist_gear::LogicalCameraImage::ConstPtr &msg);
     void quality_sensor_status_callback2(const nist_gear::LogicalCameraImage::ConstPtr &msg);
-    void PartonBeltCheck(std::vector<nist_gear::Order> received, int x_loop, std::array<std::array<modelparam, 36>, 17> logicam, std::array<std::array<int, 3>, 5> &belt_part_arr, int &on_belt);
-    part quality_sensor_status();
-    part quality_sensor_status1();
+    void PartonBeltCheck(OrderBook &orders, int &checked_orders, int x_loop, std::array<std::array<modelparam, 36>, 17> logicam, std::array<std::array<int, 3>, 5> &belt_part_arr, int &on_belt);
     void breakbeam_sensing();
     void order_callback(const nist_gear::Order::ConstPtr & msg);
     void print_order_callback();
     std::array<std::array<modelparam, 36>, 17> getter_logicam_callback();
-    std::array<std::array<std::array<part, 10>, 5>, 5> getter_part_callback();
+    OrderBook & getter_order_book();
+    BreakbeamMonitor & breakbeams();
+    FrameTable & frames();
+    QcRegistry & quality();
     void HumanDetection();
     void isHuman(int x);
     double getClock();
     double getStartTime();
-    std::array<bool, 29> beam_detect;
-    std::array<int, 21> beam_seq2 = {0};
-    std::array<int, 21> beam_seq = {0};
     std::array<int, 3> gap_nos = {0};
-    std::array<int, 4> Human = {0};
+    std::array<int, 4> humans() const;
+    bool humanDetected() const;
     std::string getCompetitionState();
     stats getStats(std::string function);
-    std::vector<nist_gear::Order> received_orders_;
-    bool Human_detected;
     geometry_msgs::TransformStamped shelf_pose_callback(std::string frame_name);
     double shelf_distance(std::string frame_id_1, std::string frame_id_2);
     std::vector<std::string>  check_gaps();
@@ -88,6 +90,12 @@ private:
     ros::Subscriber orders_subscriber_;
     ros::Subscriber fp_subscriber_,fp_subscriber1_;
 
+    OrderBook order_book_; // every product of every received order
+    BreakbeamMonitor breakbeams_; // edges of /ariac/breakbeam_*
+    FrameTable frames_; // static frames, loaded once in init()
+    QcRegistry quality_; // faulty parts on the trays, per placed product
+    std::atomic<int> human_aisles_; // bit i: a person was seen in aisle i + 1
+
 
     // to collect statistics
     stats init_;
@@ -0,0 +1,43 @@
+#ifndef DISPOSAL_PLANNER_H
+#define DISPOSAL_PLANNER_H
+
+#include <array>
+#include <vector>
+
+#include "part_selector.h"
+
+const int NUMBER_OF_DROP_POINTS = 3;
+const point2 START_POSITION = {0.0, 0.0}; // world, GantryControl::start_
+
+/**
+ * @brief Floor spot where a faulty part may be dropped.
+ */
+typedef struct DropPoint {
+    int drop; // 0..NUMBER_OF_DROP_POINTS - 1, GantryControl::dropStation
+    point2 position; // world
+} drop_point;
+
+/**
+ * @brief Chooses where to drop a faulty part taken off a tray. The drop
+ * points lie on the free strip between the belt and the bins; the one chosen
+ * is the cheapest detour between the tray and the place the gantry goes next
+ * for the replacement part.
+ */
+class DisposalPlanner
+{
+public:
+    DisposalPlanner();
+
+    int plan(point2 from, const std::vector<point2> &next);
+    const DropPoint & drop(int drop) const { return drops_[drop]; }
+
+    int disposals() const { return disposals_; }
+    double savings() const { return savings_; } // s, against going through start_ to agv_faulty and back
+
+private:
+    std::array<DropPoint, NUMBER_OF_DROP_POINTS> drops_;
+    int disposals_;
+    double savings_;
+};
+
+#endif
@@ -0,0 +1,24 @@
+#ifndef EXECUTIVE_POLICY_H
+#define EXECUTIVE_POLICY_H
+
+#include <string>
+
+#include "part_selector.h"
+
+const int STAGING_FALLBACK_BIN = 9; // belt parts go here when no bin is free
+
+/**
+ * @brief Decisions of the executive that do not need ROS, shared by FP_node
+ * and TrialSimulator so the simulator follows the same rules.
+ */
+class ExecutivePolicy
+{
+public:
+    static std::string assignedAgv(const std::string &agv, int shipment);
+    static bool routeViaStart(int camera, bool over_bins, bool from_belt);
+    static bool placeDirectly(const std::string &part_type, const std::string &needed_type, bool needed_done,
+                              bool agv_available, point2 station, point2 agv);
+    static int stagingBin(int reserved);
+};
+
+#endif
@@ -0,0 +1,61 @@
+#ifndef FEASIBILITY_CHECKER_H
+#define FEASIBILITY_CHECKER_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <utility>
+
+#include <moveit/robot_model/robot_model.h>
+#include <moveit/robot_state/robot_state.h>
+#include <moveit/planning_scene/planning_scene.h>
+
+#include "utils.h"
+
+/**
+ * @brief Cheap checks run before a joint goal is handed to the planner:
+ * joint bounds, self collision and goals that recently failed to plan from
+ * about the same start (INFEASIBLE_GOAL_EXPIRY). Also
+ * sizes the planning time budget from the planning times seen so far.
+ */
+class FeasibilityChecker
+{
+public:
+    FeasibilityChecker();
+    void init(const moveit::core::RobotModelConstPtr &robot_model, const std::string &group);
+
+    MoveStatus check(const std::vector<double> &start, const std::vector<double> &goal);
+    double planningBudget(const std::vector<double> &goal) const;
+    void recordPlan(const std::vector<double> &start, const std::vector<double> &goal, double planning_time, bool success);
+
+    int rejected() const { return rejected_; }
+
+private:
+    typedef struct PlanTimes {
+        int count = 0;
+        double mean = 0.0;
+        double m2 = 0.0; // sum of squared deviations (Welford)
+        double max = 0.0;
+    } plantimes;
+
+    static void addSample(plantimes &times, double value);
+    typedef std::pair<uint64_t, uint64_t> MotionKey; // start bucket, goal
+
+    static uint64_t goalKey(const std::vector<double> &goal);
+    static MotionKey motionKey(const std::vector<double> &start, const std::vector<double> &goal);
+
+    std::string group_;
+    planning_scene::PlanningScenePtr scene_;
+    moveit::core::RobotStatePtr state_;
+    const moveit::core::JointModelGroup* joint_model_group_;
+
+    plantimes all_plans_;
+    std::unordered_map<uint64_t, plantimes> goal_plans_;
+    std::map<MotionKey, int> motion_failures_;
+    std::map<MotionKey, double> infeasible_until_; // wall time s, rejected by check() until then
+    int rejected_;
+};
+
+#endif
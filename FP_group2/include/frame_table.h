@@ -0,0 +1,37 @@
+#ifndef FRAME_TABLE_H
+#define FRAME_TABLE_H
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <geometry_msgs/TransformStamped.h>
+
+const double FRAME_TABLE_TIMEOUT = 5.0; // s, for the whole batch, was per frame
+
+/**
+ * @brief World poses of the frames that never move (shelves, bins, kit trays,
+ * cameras), looked up once at startup with a single tf listener and then
+ * served from memory.
+ */
+class FrameTable
+{
+public:
+    FrameTable();
+
+    static std::vector<std::string> staticFrames();
+    int load(const std::vector<std::string> &frames, double timeout);
+    bool lookup(const std::string &frame, geometry_msgs::TransformStamped &transform) const;
+
+    bool loaded() const;
+    double loadTime() const { return load_time_; } // s, wall time of load()
+
+private:
+    mutable std::mutex mutex_;
+    std::map<std::string, geometry_msgs::TransformStamped> transforms_; // frame -> world pose
+    bool loaded_;
+    double load_time_;
+};
+
+#endif
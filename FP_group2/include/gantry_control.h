@@ -18,6 +18,8 @@
 #include <moveit_msgs/AttachedCollisionObject.h>
 #include <moveit_msgs/CollisionObject.h>
 #include <moveit_visual_tools/moveit_visual_tools.h>
+#include <moveit/robot_trajectory/robot_trajectory.h>
+#include <moveit/trajectory_processing/time_optimal_trajectory_generation.h>
 
 
 #include <boost/foreach.hpp>
@@ -39,6 +41,10 @@
 
 #include "utils.h"
 #include "competition.h"
+#include "plan_library.h"
+#include "feasibility_checker.h"
+#include "planner_portfolio.h"
+#include "part_selector.h"
 
 
 class GantryControl {
@@ -53,19 +59,32 @@ public:
 
 //    bool pickPart(part part, std::string arm_name);
     bool pickPart(part part);
-    void placePart(part part, std::string agv);
+    double pickLowering() const { return pick_lowering_; } // m below the requested z the last pick attached
+    void placePart(part part, std::string agv, point2 correction = {0.0, 0.0});
 
 
     /// Send command message to robot controller
     bool send_command(trajectory_msgs::JointTrajectory command_msg);
-    void goToPresetLocation(PresetLocation location);
+    MoveStatus goToPresetLocation(PresetLocation location);
+    MoveStatus takeMoveFailure();
+    bool retimePlan(moveit::planning_interface::MoveGroupInterface::Plan &plan);
+    void printRetimeReport();
+    bool openPlanLibrary(std::string path, uint64_t scene_hash);
     void initialPositions(std::map<std::string,std::vector<PresetLocation>> &presetLocation, std::array<int, 3> gap_nos, std::array<int, 4> Human, bool Human_there);
     void moveToPresetLocation(std::map<std::string,std::vector<PresetLocation>> &presetLocation, std::string &location, double x, double y, int dir, std::string type, std::array<int, 3> gap_nos, Competition &comp);
-    void placePartRight(part part, std::string agv);
+    void placePartRight(part part, std::string agv, point2 correction = {0.0, 0.0});
+    void followPresetChain(const std::vector<PresetLocation> &chain);
+    void retracePresetChain(const std::vector<PresetLocation> &chain);
 
     void activateGripper(std::string gripper_id);
     void deactivateGripper(std::string gripper_id);
     nist_gear::VacuumGripperState getGripperState(std::string arm_name);
+    point2 getGantryPosition();
+    PresetLocation beltStation(const std::string &type);
+    PresetLocation binStation(int bin);
+    PresetLocation cameraStation(int camera);
+    PresetLocation dropStation(int drop);
+    bool graspFromBelt(PresetLocation station, ros::Time grasp_time, ros::Time deadline);
     geometry_msgs::Pose getTargetWorldPose(geometry_msgs::Pose target, std::string agv);
     geometry_msgs::Pose getTargetWorldPoseRight(geometry_msgs::Pose target, std::string agv);
     //--preset locations;
@@ -79,7 +98,7 @@ public:
     lc7r lc7ra_,lc7rb_,lc7rc_, lc6r_;
     shelf11 lc8la_, lc8lb_, lc8lc_, lc9l_, lc8ra_, lc8rb_, lc9r_;
     agv2 agv2_, agv2f_, agv2flt_, agv2flb_, agv2frt_, agv2frb_, agv2a_, agv2b_, agv2c_;
-    agv2 agv_faulty;
+    agv2 agv_faulty, agv1_drop_, agv2_drop_;
     agv1 agv1_, agv1a_, agv1b_, agv1c_, agv1flipa_, agv1flipb_, agv1flt_, agv1flb_, agv1frt_, agv1frb_, agv1f_;
     left_gap_1_2 left_gap_1_2_;
     left_gap_1_3 left_gap_1_3_;
@@ -128,6 +147,26 @@ private:
 
     sensor_msgs::JointState current_joint_states_;
 
+    //--time-optimal retiming of full robot plans (gantry + both arms)
+    trajectory_processing::TimeOptimalTrajectoryGeneration totg_;
+    std::string last_preset_key_;
+    std::map<std::string, retimestats> retime_report_; // "from -> to" preset pair
+
+    //--plans kept across runs, keyed by (start bucket, goal preset, scene hash)
+    PlanLibrary plan_library_;
+    FeasibilityChecker feasibility_;
+    PlannerPortfolio portfolio_;
+
+    double pick_lowering_;
+    MoveStatus move_failure_; // see takeMoveFailure()
+
+    //--trajectories of the current pick, replayed reversed on the way back
+    moveit_msgs::RobotTrajectory last_trajectory_;
+    std::vector<moveit_msgs::RobotTrajectory> outbound_legs_;
+    MoveStatus executeReversed(const moveit_msgs::RobotTrajectory &leg);
+    bool loadCachedPlan(const std::vector<double> &start, moveit::planning_interface::MoveGroupInterface::Plan &plan);
+    void storePlan(const std::vector<double> &start, const moveit::planning_interface::MoveGroupInterface::Plan &plan);
+
 
     nist_gear::VacuumGripperState current_left_gripper_state_;
     nist_gear::VacuumGripperState current_right_gripper_state_;
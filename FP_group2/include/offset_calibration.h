@@ -0,0 +1,51 @@
+#ifndef OFFSET_CALIBRATION_H
+#define OFFSET_CALIBRATION_H
+
+#include <map>
+#include <string>
+
+const int CALIBRATION_WINDOW = 5; // observations averaged for a camera offset, older ones fade out
+const double CALIBRATION_MAX_OFFSET = 0.25; // m, larger values are not a calibration error
+const double CALIBRATION_RAISE_STEP = 0.005; // m, a grasp that attaches at once says the part may be this much higher
+
+/**
+ * @brief Height corrections learnt while running and kept across runs.
+ *
+ * Grasp offsets, per pick location (a bin, or the shelf camera for shelf
+ * parts): what to add to the camera z of a part for the gripper to reach
+ * it, averaged over the last successful grasps. Camera offsets, per logical
+ * camera: camera z minus true z of the parts it sees, from the tray cameras
+ * against the placement targets.
+ */
+class OffsetCalibration
+{
+public:
+    OffsetCalibration();
+
+    bool load(const std::string &path);
+    bool save() const;
+
+    double graspOffset(const std::string &location) const;
+    void observeGrasp(const std::string &location, double lowering);
+    double cameraOffset(int camera) const;
+    void observeCamera(int camera, double offset);
+
+    int updates() const { return updates_; }
+
+    static std::string binLocation(int bin);
+    static std::string cameraLocation(int camera);
+
+private:
+    typedef struct Offset {
+        double value = 0.0; // m
+        int samples = 0;
+    } offset;
+
+    double value(const std::string &key) const;
+
+    std::map<std::string, Offset> offsets_; // "grasp/<location>", "camera/<id>"
+    std::string path_;
+    int updates_;
+};
+
+#endif
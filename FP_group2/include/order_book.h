@@ -0,0 +1,51 @@
+#ifndef ORDER_BOOK_H
+#define ORDER_BOOK_H
+
+#include <deque>
+#include <mutex>
+#include <vector>
+
+#include <nist_gear/Order.h>
+
+#include "utils.h"
+
+/**
+ * @brief A shipment as announced by an order, products are the ids
+ * first_product .. first_product + product_count - 1.
+ */
+typedef struct ShipmentRef {
+    int order;
+    int shipment;
+    int first_product;
+    int product_count;
+} shipmentref;
+
+/**
+ * @brief Append-only store of every product of every received order.
+ * Product ids are stable and references to products stay valid while orders
+ * keep arriving, so the executive reads and annotates products in place.
+ */
+class OrderBook
+{
+public:
+    void addOrder(const nist_gear::Order &order);
+
+    int orderCount() const;
+    int shipmentCount(int order) const;
+    int productCount(int order, int shipment) const;
+
+    int productId(int order, int shipment, int product) const;
+    part & product(int id);
+    part & product(int order, int shipment, int product);
+
+    std::vector<ShipmentRef> changesSince(size_t &cursor) const;
+
+private:
+    mutable std::mutex mutex_;
+    std::deque<part> products_; // indexed by product id
+    std::vector<std::vector<ShipmentRef>> orders_;
+    std::vector<ShipmentRef> announced_; // change feed, in announcement order
+    part blank_; // returned for products that were not ordered
+};
+
+#endif
@@ -0,0 +1,56 @@
+#ifndef PART_SELECTOR_H
+#define PART_SELECTOR_H
+
+#include <array>
+#include <string>
+#include <vector>
+
+// Travel model of the gantry, world frame
+const double GANTRY_SPEED_X = 1.0; // m/s along small_long_joint
+const double GANTRY_SPEED_Y = 1.0; // m/s along torso_rail_joint
+const double SHELF_AREA_X = -1.5; // parts beyond this x (shelves 3..11) are reached through an aisle
+const double AISLE_ENTRY_X = 0.0; // x where the gantry turns into an aisle
+const std::array<double, 4> AISLE_Y = {4.57, 1.57, -1.57, -4.57}; // aisles 1..4
+const double HUMAN_AISLE_PENALTY = 20.0; // s, waiting for or going around a person
+const double PICK_PLACE_TIME = 10.0; // s, grasp + place, same for every instance
+
+typedef struct Point2 {
+    double x, y;
+} point2;
+
+const point2 AGV1_POSITION = {-0.55, 6.95};
+const point2 AGV2_POSITION = {0.6, -6.9};
+
+/**
+ * @brief A part seen by a logical camera that could serve the product.
+ */
+typedef struct Candidate {
+    int camera, slot;
+    point2 position; // world
+    double cost; // estimated round trip, filled by PartSelector::rank
+} candidate;
+
+/**
+ * @brief Orders the instances of a part type by the estimated time to go
+ * from the gantry to the part, then to the target AGV.
+ */
+class PartSelector
+{
+public:
+    PartSelector();
+
+    static double legTime(point2 from, point2 to);
+    static int aisleOf(point2 position);
+    double travelTime(point2 from, point2 to, const std::array<int, 4> &human) const;
+
+    void rank(std::vector<Candidate> &candidates, point2 gantry, point2 agv, const std::array<int, 4> &human);
+
+    long selections() const { return selections_; }
+    double rankingTime() const { return ranking_time_; } // s, summed over all rank() calls
+
+private:
+    long selections_;
+    double ranking_time_;
+};
+
+#endif
@@ -0,0 +1,39 @@
+#ifndef PICK_SEQUENCER_H
+#define PICK_SEQUENCER_H
+
+#include <array>
+#include <vector>
+
+#include "part_selector.h"
+
+const int SEQUENCER_MAX_PASSES = 50; // local search passes, each one O(n^2) moves
+
+/**
+ * @brief One product to fetch: where its part is and where it goes.
+ */
+typedef struct Visit {
+    int product_id;
+    point2 pick;
+    point2 drop; // target AGV
+} visit;
+
+/**
+ * @brief Orders the products of one or more shipments so the gantry wastes
+ * as little travel as possible between dropping a part and picking the next
+ * one. Nearest neighbour construction improved by relocating single visits
+ * and reversing segments until no move helps.
+ */
+class PickSequencer
+{
+public:
+    explicit PickSequencer(const PartSelector &travel);
+
+    std::vector<int> sequence(const std::vector<Visit> &visits, point2 start, const std::array<int, 4> &human) const;
+    double cost(const std::vector<Visit> &visits, const std::vector<int> &order, point2 start,
+                const std::array<int, 4> &human) const;
+
+private:
+    const PartSelector &travel_;
+};
+
+#endif
@@ -0,0 +1,46 @@
+#ifndef PLACEMENT_CORRECTOR_H
+#define PLACEMENT_CORRECTOR_H
+
+#include <map>
+#include <string>
+
+#include "part_selector.h"
+
+const double PLACEMENT_TOLERANCE = 0.03; // m, offset on the tray that needs a regrasp
+const double PLACEMENT_OUTLIER = 0.1; // m, larger errors come from a wrong camera match, not from a bias
+const double PLACEMENT_MAX_CORRECTION = 0.05; // m, per axis
+const int PLACEMENT_WINDOW = 5; // observations averaged, older ones fade out
+
+/**
+ * @brief Learns the systematic placement error of each arm on each AGV for
+ * each part type, from the tray cameras (10 and 11) after a placement, and
+ * gives the world offset to add to the next target so it lands where it
+ * should. Part types without observations yet use the mean over the types
+ * placed by the same arm on the same AGV.
+ */
+class PlacementCorrector
+{
+public:
+    PlacementCorrector();
+
+    point2 correction(const std::string &arm, const std::string &agv, const std::string &type) const;
+    bool observe(const std::string &arm, const std::string &agv, const std::string &type,
+                 point2 target, point2 applied, point2 observed);
+
+    int placements() const { return placements_; }
+    int regrasps() const { return regrasps_; }
+
+private:
+    typedef struct Bias {
+        point2 mean = {0.0, 0.0}; // observed - commanded, world
+        int samples = 0;
+    } bias;
+
+    static void add(Bias &bias, point2 error);
+
+    std::map<std::string, Bias> by_type_; // arm/agv/type
+    std::map<std::string, Bias> by_arm_; // arm/agv
+    int placements_, regrasps_;
+};
+
+#endif
@@ -0,0 +1,97 @@
+#ifndef PLAN_LIBRARY_H
+#define PLAN_LIBRARY_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+const double PLAN_START_BUCKET = 0.02; // rad or m, start states closer than this share plans
+const double PLAN_GOAL_RESOLUTION = 0.001; // rad or m, preset targets are exact
+
+/**
+ * @brief On-disk record layout. A record header is followed by
+ * point_count * (1 + 3 * joint_count) doubles: for every point the time from
+ * start, then positions, velocities and accelerations.
+ */
+typedef struct PlanRecordHeader {
+    uint64_t start_bucket;
+    uint64_t goal_key;
+    uint64_t scene_hash;
+    uint32_t point_count;
+    uint32_t joint_count;
+} planrecordheader;
+
+/**
+ * @brief Read-only view of a stored plan. Points into the mapped file, so it
+ * is only valid until the next store() or setSceneHash().
+ */
+typedef struct PlanView {
+    const PlanRecordHeader* header = nullptr;
+    const double* data = nullptr;
+
+    double time(uint32_t point) const { return data[point * stride()]; }
+    const double* positions(uint32_t point) const { return data + point * stride() + 1; }
+    const double* velocities(uint32_t point) const { return positions(point) + header->joint_count; }
+    const double* accelerations(uint32_t point) const { return velocities(point) + header->joint_count; }
+    uint32_t stride() const { return 1 + 3 * header->joint_count; }
+} planview;
+
+/**
+ * @brief Append-only, memory-mapped library of joint trajectories keyed by
+ * (start bucket, goal preset, scene hash). Opening a library maps the file and
+ * indexes record headers only; trajectories are read in place.
+ */
+class PlanLibrary
+{
+public:
+    PlanLibrary();
+    ~PlanLibrary();
+    PlanLibrary(const PlanLibrary &) = delete;
+    PlanLibrary & operator=(const PlanLibrary &) = delete;
+
+    bool open(const std::string &path);
+    void close();
+    bool isOpen() const { return fd_ >= 0; }
+
+    void setSceneHash(uint64_t scene_hash);
+    uint64_t getSceneHash() const { return scene_hash_; }
+
+    bool lookup(const std::vector<double> &start, const std::vector<double> &goal, PlanView &view) const;
+    bool store(const std::vector<double> &start, const std::vector<double> &goal,
+               uint32_t joint_count, const std::vector<double> &data);
+
+    size_t size() const { return index_.size(); }
+    int hits() const { return hits_; }
+    int misses() const { return misses_; }
+
+    static uint64_t hashValues(const std::vector<double> &values, double resolution);
+
+private:
+    struct Key {
+        uint64_t start_bucket, goal_key, scene_hash;
+        bool operator==(const Key &other) const {
+            return start_bucket == other.start_bucket && goal_key == other.goal_key && scene_hash == other.scene_hash;
+        }
+    };
+    struct KeyHash {
+        size_t operator()(const Key &key) const {
+            return key.start_bucket ^ (key.goal_key * 31) ^ (key.scene_hash * 131);
+        }
+    };
+
+    bool remap();
+    void buildIndex();
+    bool compact();
+
+    std::string path_;
+    int fd_;
+    const char* map_;
+    size_t map_size_;
+    uint64_t scene_hash_;
+    std::unordered_map<Key, size_t, KeyHash> index_; // key -> record offset in the file
+    mutable int hits_;
+    mutable int misses_;
+};
+
+#endif
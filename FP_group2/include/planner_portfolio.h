@@ -0,0 +1,70 @@
+#ifndef PLANNER_PORTFOLIO_H
+#define PLANNER_PORTFOLIO_H
+
+#include <future>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <moveit_msgs/MotionPlanRequest.h>
+#include <moveit_msgs/MotionPlanResponse.h>
+
+const int PORTFOLIO_MIN_RACES = 10; // races in a motion class before pruning it
+const double PORTFOLIO_MIN_WIN_SHARE = 0.1; // planners winning less often are dropped
+const double PORTFOLIO_BUDGET_MARGIN = 2.0; // per-planner budget, times the slowest win of the class
+const double PORTFOLIO_MIN_BUDGET = 0.5; // never give a planner less than this [s]
+
+struct RaceState;
+
+/**
+ * @brief Races several planner configurations on the same request through
+ * move_group's plan_kinematic_path service and keeps the first valid plan.
+ * Wins are counted per motion class so planners that never win a class stop
+ * being launched for it.
+ *
+ * Losers are not cancelled: each call runs to its own allowed_planning_time
+ * on the move_group side. Once a class has PORTFOLIO_MIN_RACES races, every
+ * planner gets PORTFOLIO_BUDGET_MARGIN times the slowest win of the class
+ * instead of the full request budget, so losers stop shortly after a winner
+ * would have. Calls run on std::async futures that are joined before the next
+ * race and on destruction. move_group may serve the calls one at a time;
+ * printReport() shows how much they overlapped and how long losers kept
+ * planning after the winner.
+ */
+class PlannerPortfolio
+{
+public:
+    PlannerPortfolio();
+    ~PlannerPortfolio();
+    void init(const std::string &service_name, const std::vector<std::string> &planner_ids);
+    bool enabled() const { return !planner_ids_.empty(); }
+
+    bool race(const moveit_msgs::MotionPlanRequest &request, const std::string &motion_class,
+              moveit_msgs::MotionPlanResponse &response);
+    std::vector<std::string> activePlanners(const std::string &motion_class) const;
+    double plannerBudget(const moveit_msgs::MotionPlanRequest &request, const std::string &motion_class) const;
+    void printReport();
+
+private:
+    /// Calls of the previous race, joined before the next one
+    struct Race {
+        std::string motion_class;
+        std::shared_ptr<RaceState> state;
+        std::vector<std::future<void>> calls;
+    };
+
+    void joinPrevious();
+
+    std::string service_name_;
+    std::vector<std::string> planner_ids_;
+    std::map<std::string, int> races_; // motion class -> races run
+    std::map<std::string, std::map<std::string, int>> wins_; // motion class -> planner -> wins
+    std::map<std::string, double> slowest_win_; // motion class -> longest winning planning_time [s]
+    std::map<std::string, double> busy_; // motion class -> summed duration of all calls [s]
+    std::map<std::string, double> wall_; // motion class -> first call sent to last call back [s]
+    std::map<std::string, double> past_winner_; // motion class -> last call back minus winner back [s]
+    Race previous_;
+};
+
+#endif
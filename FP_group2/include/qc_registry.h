@@ -0,0 +1,78 @@
+#ifndef QC_REGISTRY_H
+#define QC_REGISTRY_H
+
+#include <condition_variable>
+#include <future>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <geometry_msgs/Pose.h>
+#include <ros/time.h>
+
+#include "task_scheduler.h"
+
+const double QC_MATCH_RADIUS = 0.1; // m, detection <-> placement target distance on the tray
+const double QC_SETTLE_TIME = 0.2; // s, sensor messages this soon after a placement may predate it
+const double QC_VERDICT_TIMEOUT = 1.0; // s, the sleep the executive used to take before reading the sensor
+
+enum QcStatus { QC_PENDING, QC_GOOD, QC_FAULTY };
+
+/**
+ * @brief A faulty part seen by a quality control sensor, world frame.
+ */
+typedef struct QcDetection {
+    std::string type;
+    geometry_msgs::Pose pose;
+    ros::Time first_seen, last_seen;
+} qc_detection;
+
+/**
+ * @brief A product placed on a tray, and what the sensor says about it.
+ */
+typedef struct QcSlot {
+    Task task; // product_id -1 for a faulty part no placement explains
+    std::string agv;
+    geometry_msgs::Pose target; // world
+    ros::Time placed;
+    QcStatus status;
+    QcDetection detection; // valid if status is QC_FAULTY
+} qc_slot;
+
+/**
+ * @brief Every product on the AGV trays with its quality verdict.
+ *
+ * The sensor callbacks report all faulty parts they currently see; each is
+ * matched to the nearest placement on that tray. A placement is good once a
+ * sensor message newer than placement + QC_SETTLE_TIME does not show it.
+ */
+class QcRegistry
+{
+public:
+    QcRegistry();
+
+    void update(const std::string &agv, const std::vector<QcDetection> &faulty, ros::Time stamp);
+
+    void placed(const std::string &agv, const Task &task, const geometry_msgs::Pose &target, ros::Time stamp);
+    void removed(const std::string &agv, int product_id);
+
+    QcSlot verdict(const std::string &agv, int product_id) const;
+    QcSlot await(const std::string &agv, int product_id, double timeout);
+    std::future<QcSlot> verdictAsync(const std::string &agv, int product_id, double timeout);
+    std::vector<QcSlot> faulty(const std::string &agv) const;
+
+    int faultyCount() const { return faulty_seen_; }
+
+private:
+    QcSlot classify(const QcSlot &slot) const;
+
+    mutable std::mutex mutex_;
+    std::condition_variable updated_;
+    std::map<std::string, std::vector<QcSlot>> slots_; // agv -> placements on its tray
+    std::map<std::string, std::vector<QcDetection>> detections_; // agv -> faulty parts in the last message
+    std::map<std::string, ros::Time> last_update_; // agv -> stamp of the last message
+    int faulty_seen_;
+};
+
+#endif
@@ -0,0 +1,31 @@
+#ifndef REGION_PREDICTOR_H
+#define REGION_PREDICTOR_H
+
+#include <array>
+#include <vector>
+
+const int REGION_LOOKAHEAD = 3; // upcoming products that vote for the next region
+const int NUMBER_OF_BIN_CAMERAS = 4; // logical cameras 0..3 watch the bins
+
+/**
+ * @brief Guesses which bin area the gantry will pick from next, so it can
+ * wait there instead of at the start position. Each upcoming product votes
+ * for the bin cameras that see a usable part of its type, the next product
+ * counting most. Parts only on the shelves or the belt give no vote.
+ */
+class RegionPredictor
+{
+public:
+    RegionPredictor();
+
+    int predict(const std::vector<std::vector<int>> &cameras) const;
+    void record(int predicted, int used);
+
+    int hits() const { return hits_; }
+    int misses() const { return misses_; }
+
+private:
+    int hits_, misses_;
+};
+
+#endif
@@ -0,0 +1,47 @@
+#ifndef STAGING_BUFFER_H
+#define STAGING_BUFFER_H
+
+#include <array>
+#include <vector>
+
+#include "part_selector.h"
+
+const int NUMBER_OF_BINS = 16;
+const double BIN_HALF_WIDTH_X = 0.3; // m, part inside a bin if this close to its center
+const double BIN_HALF_WIDTH_Y = 0.28;
+
+/**
+ * @brief A bin the gantry can drop a part into.
+ */
+typedef struct StagingSlot {
+    int bin; // 1..16
+    int camera; // logical camera watching the bin
+    point2 center; // world, where a part dropped from the bin preset lands
+    bool usable; // bin preset reaches the drop point and the pick side finds it again
+} staging_slot;
+
+/**
+ * @brief Free bins to park belt parts in until their product is served.
+ * A bin is free when no part in the inventory lies inside it; the staged
+ * part goes to the free bin closest to the AGV it is meant for.
+ */
+class StagingBuffer
+{
+public:
+    StagingBuffer();
+
+    int binAt(point2 position) const;
+    int nearest(point2 agv, const std::vector<point2> &inventory) const;
+    int reserve(point2 agv, const std::vector<point2> &inventory);
+    const StagingSlot & slot(int bin) const { return slots_[bin - 1]; }
+    int freeSlots(const std::vector<point2> &inventory) const;
+    int staged() const { return staged_; }
+
+private:
+    bool isFree(const StagingSlot &slot, const std::vector<point2> &inventory) const;
+
+    std::array<StagingSlot, NUMBER_OF_BINS> slots_;
+    int staged_;
+};
+
+#endif
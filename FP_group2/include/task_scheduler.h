@@ -0,0 +1,70 @@
+#ifndef TASK_SCHEDULER_H
+#define TASK_SCHEDULER_H
+
+#include <map>
+#include <queue>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+const int MAX_TASK_ATTEMPTS = 3; // a product that cannot be found is deferred this many times
+
+/**
+ * @brief One product to pick and place on its AGV.
+ */
+typedef struct Task {
+    int order, shipment, product; // position in the order book
+    int product_id;
+    int priority; // higher runs first
+    int attempts;
+    unsigned long sequence; // FIFO among tasks of equal priority
+} task;
+
+/**
+ * @brief Priority queue of pick/place tasks. The executive takes one task at
+ * a time, so a higher priority order added between two tasks preempts the
+ * current one at the next safe point (after a placement).
+ */
+class TaskScheduler
+{
+public:
+    explicit TaskScheduler(int max_attempts = MAX_TASK_ATTEMPTS);
+
+    void addShipment(int order, int shipment, int first_product, int product_count, int priority);
+    bool next(Task &task);
+    bool complete(int product_id);
+    bool defer(Task task);
+    void reopen(Task task);
+    std::vector<Task> pendingTasks(int priority) const;
+    std::vector<Task> upcoming(int count) const;
+    void reorder(const std::vector<int> &product_ids);
+
+    bool isComplete(int product_id) const { return done_.count(product_id) > 0; }
+    int pending() const { return queue_.size(); }
+    int preemptions() const { return preemptions_; }
+    int dropped() const { return dropped_; }
+
+private:
+    struct Later {
+        bool operator()(const Task &a, const Task &b) const {
+            if (a.priority != b.priority)
+                return a.priority < b.priority;
+            return a.sequence > b.sequence;
+        }
+    };
+
+    void skipDone();
+
+    std::priority_queue<Task, std::vector<Task>, Later> queue_;
+    std::unordered_set<int> done_; // completed product ids
+    std::unordered_map<int, std::pair<int, int>> shipment_of_; // product id -> (order, shipment)
+    std::map<std::pair<int, int>, int> remaining_; // (order, shipment) -> products left
+    int max_attempts_;
+    unsigned long sequence_;
+    int last_priority_;
+    int preemptions_;
+    int dropped_;
+};
+
+#endif
@@ -0,0 +1,182 @@
+#ifndef TRIAL_SIMULATOR_H
+#define TRIAL_SIMULATOR_H
+
+#include <array>
+#include <map>
+#include <queue>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "part_selector.h"
+#include "pick_sequencer.h"
+#include "task_scheduler.h"
+#include "belt_interceptor.h"
+#include "staging_buffer.h"
+#include "region_predictor.h"
+
+// Stand-ins for what Gazebo and the robot would do, rough averages of real runs
+const double SIM_PICK_SUCCESS = 0.95; // chance a grasp on a bin or shelf holds
+const double SIM_BELT_GRASP_SUCCESS = 0.9; // chance a belt interception holds
+const double SIM_PICK_TIME = 4.0; // s, descend, grasp and lift
+const double SIM_PLACE_TIME = 4.0; // s, place on the tray and release
+const double SIM_FLIP_TIME = 8.0; // s, hand the part over to the right arm
+const double SIM_QC_TIME = 1.0; // s, quality sensor verdict after a placement
+const double SIM_DISPOSE_TIME = 6.0; // s, faulty part back off the tray
+const double SIM_BELT_SPAWN_Y = 4.3; // world y where belt parts appear
+const double SIM_CAMERA_12_Y = 2.5; // world y under the belt camera
+const double SIM_BELT_END_Y = -4.3; // parts fall off the belt here
+const double SIM_BELT_CYCLE = 20.0; // s between two populations of the belt
+const double SIM_BELT_X = 0.15; // world x of the belt presets
+const double SIM_BELT_SPEED = 0.2; // m/s, BELT_SPEED of utils.h, which needs ROS
+const int SIM_PICKING_ATTEMPTS = 3; // MAX_PICKING_ATTEMPTS of utils.h
+const std::array<double, 4> SIM_SHELF_SLOT_X = {-2.8, -7.2, -11.58, -14.5}; // shelf_layout columns
+const std::array<double, 3> SIM_SHELF_ROW_Y = {3.05, 0.0, -3.05}; // shelf_layout rows
+const point2 SIM_SHELF1_POSITION = {4.1, 3.6};
+const point2 SIM_SHELF2_POSITION = {4.1, -3.6};
+const point2 SIM_START_POSITION = {0.0, 0.0};
+const int SIM_SHELF_CAMERA = 100; // shelf parts get camera SIM_SHELF_CAMERA + shelf number
+
+/**
+ * @brief A part lying in a bin or on a shelf.
+ */
+typedef struct SimPart {
+    std::string type, name;
+    point2 position;
+    int camera;
+    bool faulty;
+    bool used;
+} sim_part;
+
+/**
+ * @brief A part travelling on the belt, y = spawn y - BELT_SPEED * (t - spawned).
+ */
+typedef struct SimBeltPart {
+    std::string type, name;
+    double spawned;
+    bool faulty;
+    bool taken;
+} sim_belt_part;
+
+/**
+ * @brief One product of one shipment, as the trial asks for it.
+ */
+typedef struct SimProduct {
+    int order, shipment;
+    std::string type, agv;
+    bool flip;
+    bool placed;
+    double placed_at;
+} sim_product;
+
+typedef struct SimOrder {
+    std::string condition; // time, wanted_products or unwanted_products
+    double value;
+    int shipment_count;
+    std::vector<std::string> destinations;
+    std::vector<std::pair<std::string, bool>> products; // type, flipped
+    bool announced;
+    double announced_at, completed_at;
+} sim_order;
+
+/**
+ * @brief Someone walking up and down an aisle: moves for move_time, waits
+ * wait_time at the end, comes back, waits again.
+ */
+typedef struct SimPerson {
+    double location; // world y of the aisle
+    double start_time, move_time, wait_time;
+} sim_person;
+
+typedef struct SimMetrics {
+    double score = 0.0, max_score = 0.0;
+    double makespan = 0.0; // s, last shipment submitted
+    int products = 0, placed = 0, dropped = 0;
+    int picks = 0, failed_picks = 0, faulty_replaced = 0;
+    int belt_grasped = 0, belt_missed = 0, belt_direct = 0, belt_staged = 0;
+    double travel_time = 0.0, aisle_wait = 0.0, belt_wait = 0.0;
+    std::vector<double> cycle_times; // s, task start -> placed, per product
+    std::vector<double> order_times; // s, announced -> last shipment submitted, per order
+} sim_metrics;
+
+/**
+ * @brief Headless discrete-event run of a trial YAML. Orders, belt spawns and
+ * aisle traffic come from the trial, gantry motion from the PartSelector
+ * travel model, and the executive's decision modules (scheduler, part
+ * selection, sequencing, belt interception, staging, pre-positioning) and
+ * ExecutivePolicy make the same choices they would make in Gazebo. The task
+ * loop itself mirrors FP_node's and has to follow its changes. With old_loop, tasks run the
+ * way the nested order/shipment/product loop ran them before TaskScheduler:
+ * in order book order, a product that is not found is given up at once.
+ */
+class TrialSimulator
+{
+public:
+    explicit TrialSimulator(unsigned seed, bool old_loop = false);
+
+    bool load(const std::string &path);
+    SimMetrics run();
+    static void printReport(const std::vector<SimMetrics> &runs);
+
+private:
+    typedef struct Event {
+        double time;
+        int kind; // EVENT_ORDER or EVENT_BELT
+        int index;
+        bool operator>(const Event &other) const { return time > other.time; }
+    } event;
+    enum { EVENT_ORDER, EVENT_BELT };
+
+    void reset();
+    void advance(double time);
+    void announceOrders();
+    int unwantedFor(const SimOrder &order) const;
+    void addShipments(int order);
+    double travel(point2 to);
+    double aisleDelay(int aisle, double time) const;
+    std::array<int, 4> humans() const;
+    std::string agvOf(const SimProduct &product) const;
+    point2 agvPosition(const std::string &agv) const;
+    void interceptBelt(const Task &task);
+    bool placeProduct(const Task &task, bool faulty);
+    void submitShipment(const Task &task);
+    int beltSighted() const;
+    BeltSighting sightingOf(const SimBeltPart &part) const;
+    int nextBeltPart(const std::string &type) const;
+    bool beltNeeded(const std::string &type) const;
+    void prePosition();
+    double beltY(const SimBeltPart &part, double time) const;
+    double stationY(const std::string &type) const;
+
+    std::mt19937 random_;
+    bool old_loop_; // the nested order loop the scheduler replaced: no deferral, no sequencing
+    double time_limit_;
+    int belt_cycles_;
+    std::vector<SimOrder> orders_;
+    std::vector<SimPart> initial_parts_;
+    std::vector<std::pair<std::string, double>> belt_models_; // type, spawn time in the cycle
+    std::vector<std::string> faulty_names_;
+    std::vector<SimPerson> people_;
+
+    // state of one run
+    double clock_;
+    point2 gantry_;
+    int waiting_at_;
+    std::vector<SimPart> parts_;
+    std::vector<SimBeltPart> belt_;
+    std::vector<SimProduct> products_;
+    std::map<std::pair<int, int>, double> submitted_; // (order, shipment) -> time submitted
+    std::map<std::string, int> spawned_; // type -> instances so far, for model names
+    std::map<std::string, int> initial_spawned_; // spawned_ once the bins and shelves are filled
+    std::priority_queue<Event, std::vector<Event>, std::greater<Event>> events_;
+    int wanted_, unwanted_; // products placed, faulty parts placed
+    TaskScheduler scheduler_;
+    PartSelector selector_;
+    PickSequencer sequencer_;
+    BeltInterceptor interceptor_;
+    StagingBuffer staging_;
+    RegionPredictor predictor_;
+    SimMetrics metrics_;
+};
+
+#endif
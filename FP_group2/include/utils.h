@@ -33,12 +33,19 @@ const double BELT_SPEED = 0.2; // m/s
 
 const double GRIPPER_HEIGHT = 0.01;
 const double EPSILON = 0.008; // for the gripper to firmly touch
+const double GRASP_RETRY_STEP = 0.01; // m, a grasp that does not attach is retried this much lower
 
 const double BIN_HEIGHT = 0.724;
 const double TRAY_HEIGHT = 0.755;
 const double RAIL_HEIGHT = 0.95;
 
 const double PLANNING_TIME = 20; // for move_group
+const double MIN_PLANNING_TIME = 1.0; // lower bound of the adaptive planning budget
+const int MAX_PLAN_FAILURES = 2; // failed plans before a motion is considered infeasible
+const double INFEASIBLE_GOAL_EXPIRY = 30.0; // s, an infeasible motion is planned for again after this
+const double REVERSAL_START_TOLERANCE = 0.01; // rad or m, replay a leg backwards only from its end
+const double MAX_VELOCITY_SCALING = 1.0; // retiming, fraction of URDF velocity limits
+const double MAX_ACCELERATION_SCALING = 1.0; // retiming, fraction of URDF acceleration limits
 const int MAX_EXCHANGE_ATTEMPTS = 6; // Pulley flip
 
 extern std::string action_state_name[];
@@ -47,6 +54,11 @@ extern std::unordered_map<std::string, double> model_height;
 enum PartStates {FREE, BOOKED, UNREACHABLE, ON_TRAY, GRIPPED, GOING_HOME,
     REMOVE_FROM_TRAY, LOST};
 
+// Outcome of a preset move, see GantryControl::goToPresetLocation
+enum MoveStatus {MOVE_SUCCESS, MOVE_OUT_OF_BOUNDS, MOVE_SELF_COLLISION, MOVE_KNOWN_INFEASIBLE,
+    MOVE_PLAN_FAILED, MOVE_EXECUTION_FAILED};
+extern std::string move_status_name[];
+
 
 
 typedef struct PresetLocation {
@@ -108,6 +120,7 @@ typedef struct ModelParam{
     std::string type; // model type
     geometry_msgs::Pose pose;
     std::string frame; // model frame (e.g., "logical_camera_1_frame")
+    ros::Time time_stamp; // last time the camera reported it
     bool Shifted;
 } modelparam;
 
@@ -123,5 +136,11 @@ typedef struct Stats {
     int fails = 0;
 } stats;
 
+typedef struct RetimeStats {
+    double planned_duration = 0.0; // sum of trajectory durations as planned
+    double retimed_duration = 0.0; // sum of trajectory durations after retiming
+    int calls = 0;
+} retimestats;
+
 
 #endif
\ No newline at end of file
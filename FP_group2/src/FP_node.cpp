@@ -14,6 +14,10 @@
 
 
 #include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <future>
+#include <set>
 #include <vector>
 
 #include <ros/ros.h>
@@ -29,53 +33,131 @@
 #include <tf2_ros/transform_listener.h>
 #include <geometry_msgs/TransformStamped.h>
 #include <tf2_geometry_msgs/tf2_geometry_msgs.h> //--needed for tf2::Matrix3x3
-#include <nist_gear/AGVControl.h>
+#include "agv_dispatcher.h"
 #include "competition.h"
 #include "utils.h"
 #include "gantry_control.h"
+#include "task_scheduler.h"
+#include "part_selector.h"
+#include "pick_sequencer.h"
+#include "belt_interceptor.h"
+#include "staging_buffer.h"
+#include "region_predictor.h"
+#include "aisle_predictor.h"
+#include "aisle_monitor.h"
+#include "disposal_planner.h"
+#include "placement_corrector.h"
+#include "offset_calibration.h"
+#include "executive_policy.h"
 
 #include <tf2/LinearMath/Quaternion.h>
 
-bool submitOrder(int AVG_id, std::string shipment_type){
-    ROS_INFO("[submitOrder] Submitting order via AVG");
-
-    // Create a node to call service from. Would be better to use one existing node
-    // rather than creating a new one every time
-    ros::NodeHandle node;
-
-    // Create a Service client for the correct service, i.e. '/ariac/agv{AVG_id}'
-    ros::ServiceClient avg_client;
-
-    // Assign the service client to the correct service
-    if(AVG_id == 1){
-        avg_client = node.serviceClient<nist_gear::AGVControl>("/ariac/agv1");
-    }else if(AVG_id == 2){
-        avg_client = node.serviceClient<nist_gear::AGVControl>("/ariac/agv2");
-    }else{
-        ROS_ERROR_STREAM("[submitOrder] No AVG with id " << AVG_id <<". Valid ids are 1 and 2 only");
-    }
+/// Submit the shipment @p product belongs to on the AGV it was assigned
+std::shared_future<bool> submitShipment(AgvDispatcher &dispatcher, const part &product){
+    ROS_INFO_STREAM("\n Submitting Order: " << product.shipment);
+    if (product.agv_id == "agv1")
+        return dispatcher.submit(1, product.shipment);
+    else if (product.agv_id == "agv2")
+        return dispatcher.submit(2, product.shipment);
+    ROS_ERROR_STREAM("[submitShipment] shipment " << product.shipment << " has no AGV assigned");
+    return dispatcher.submit(0, product.shipment);
+}
 
-    // Wait for client to start
-    if (!avg_client.exists()) {
-        avg_client.waitForExistence();
+/**
+ * @brief Reorder the waiting tasks of one priority level (one order, all of
+ * its shipments) so the gantry goes from each AGV to the nearest next part.
+ * Products with no part in sight (e.g. still on the belt) keep their place.
+ */
+void sequenceTasks(TaskScheduler &scheduler, int priority, OrderBook &order_book,
+                   const std::array<std::array<modelparam, 36>, 17> &logicam, point2 start,
+                   const std::array<int, 4> &human, const PickSequencer &sequencer){
+    auto started = ros::WallTime::now();
+    std::vector<Visit> visits;
+    std::vector<int> fifo;
+    std::array<std::array<bool, 36>, 17> claimed = {};
+    for (auto &task : scheduler.pendingTasks(priority)) {
+        part &product = order_book.product(task.product_id);
+        std::string agv = ExecutivePolicy::assignedAgv(product.agv_id, task.shipment);
+
+        int best_x = -1, best_y = -1;
+        double best_time = 0.0;
+        for (int x = 0; x < 17; x++) {
+            if (x == 10 || x == 11 || x == 12)      // AGV trays and belt
+                continue;
+            for (int y = 0; y < 36; y++) {
+                if (claimed[x][y] || logicam[x][y].type != product.type || logicam[x][y].Shifted)
+                    continue;
+                double time = PartSelector::legTime(start, {logicam[x][y].pose.position.x, logicam[x][y].pose.position.y});
+                if (best_x < 0 || time < best_time) {
+                    best_x = x;
+                    best_y = y;
+                    best_time = time;
+                }
+            }
+        }
+        if (best_x < 0)
+            continue;
+        claimed[best_x][best_y] = true;
+        fifo.push_back(visits.size());
+        visits.push_back({task.product_id,
+                          {logicam[best_x][best_y].pose.position.x, logicam[best_x][best_y].pose.position.y},
+                          agv == "agv1" ? AGV1_POSITION : AGV2_POSITION});
     }
+    if (visits.size() < 2)
+        return;
+
+    auto order = sequencer.sequence(visits, start, human);
+    scheduler.reorder(order);
+
+    std::vector<int> indices;
+    for (auto product_id : order)
+        for (size_t v = 0; v < visits.size(); v++)
+            if (visits[v].product_id == product_id)
+                indices.push_back(v);
+    ROS_INFO_STREAM("[sequenceTasks] " << visits.size() << " products of priority " << priority << ": "
+                    << sequencer.cost(visits, fifo, start, human) << " s in order, "
+                    << sequencer.cost(visits, indices, start, human) << " s sequenced, solved in "
+                    << (ros::WallTime::now() - started).toSec() * 1000.0 << " ms");
+}
 
-    // Debug what you're doing
-    ROS_INFO_STREAM("[submitOrder] Sending AVG " << AVG_id << " to submit order");
-
-    // Create the message and assign the shipment type to it
-    nist_gear::AGVControl srv;
-    srv.request.shipment_type = shipment_type;
-
-    // Send message and retrieve response
-    avg_client.call(srv);
-    if (!srv.response.success) {  // If not successful, print out why.
-        ROS_ERROR_STREAM("[submitOrder]  Failed to submit: " << srv.response.message);
-    } else {
-        ROS_INFO("[submitOrder] Submitted");
-    }
+/// World positions of the parts known to be in the bins (cameras 0..3)
+std::vector<point2> binInventory(const std::array<std::array<modelparam, 36>, 17> &logicam){
+    std::vector<point2> parts;
+    for (int x = 0; x < 4; x++)
+        for (int y = 0; y < 36; y++)
+            if (!logicam[x][y].type.empty() && !logicam[x][y].Shifted)
+                parts.push_back({logicam[x][y].pose.position.x, logicam[x][y].pose.position.y});
+    return parts;
+}
 
-    return srv.response.success;
+/**
+ * @brief Add a part just dropped in a staging bin to the inventory, so it is
+ * a candidate for its product without waiting for the camera. The camera's
+ * pose is used if it already reports the part, else the bin center.
+ */
+void registerStagedPart(std::array<std::array<modelparam, 36>, 17> &logicam,
+                        const std::array<std::array<modelparam, 36>, 17> &live, const StagingSlot &slot,
+                        const std::string &type){
+    modelparam staged;
+    staged.type = type;
+    staged.frame = "logical_camera_" + std::to_string(slot.camera) + "_frame";
+    staged.pose.position.x = slot.center.x;
+    staged.pose.position.y = slot.center.y;
+    staged.pose.position.z = BIN_HEIGHT;
+    staged.pose.orientation.w = 1.0;
+    staged.time_stamp = ros::Time::now();
+    staged.Shifted = false;
+    for (auto &seen : live[slot.camera])
+        if (seen.type == type && std::fabs(seen.pose.position.x - slot.center.x) < BIN_HALF_WIDTH_X
+            && std::fabs(seen.pose.position.y - slot.center.y) < BIN_HALF_WIDTH_Y)
+            staged.pose = seen.pose;
+
+    for (auto &entry : logicam[slot.camera])
+        if (entry.type.empty() || entry.Shifted) {
+            entry = staged;
+            return;
+        }
+    ROS_WARN_STREAM("[registerStagedPart] camera " << slot.camera << " table full, " << type << " not registered");
 }
 
 int main(int argc, char ** argv) {
@@ -84,19 +166,16 @@ int main(int argc, char ** argv) {
     ros::AsyncSpinner spinner(8);
     spinner.start();
 
+    AislePredictor aisles;      //before comp, its breakbeam callbacks use it
     Competition comp(node);
     comp.init();
 
 
-    int Max_number_of_cameras = 17, Max_number_of_breakbeams = 29;
+    int Max_number_of_cameras = 17, Max_number_of_breakbeams = NUMBER_OF_BREAKBEAMS;
     std::ostringstream otopic;
     std::string topic;
     std::array<std::array<modelparam, 36>, 17> logicam, logicam2, logicam12;
-    std::array < std::array < std::array < part, 10 >, 5 >, 5 > or_details, or_details_new, order_call;
-    std::array < std::array < std::array < int, 10 >, 5 >, 5 > order_flag = {0};
-    std::array<int, 5> completed2 = {0};
-    part faulty_part, faulty_pose;
-    double Model_adjust =0;     //Only required for AGV1 cases. offset of 0.17 observed in Camera and target.
+    part faulty_pose;
     bool break_beam;
     std::string c_state = comp.getCompetitionState();
     comp.getClock();
@@ -123,577 +202,804 @@ int main(int argc, char ** argv) {
                 &Competition::breakbeam_sensor_callback, &comp, _1, x));
     }
 
+    AgvDispatcher dispatcher(node);
+    dispatcher.init();
+
     GantryControl gantry(node);
     gantry.init();
     gantry.goToPresetLocation(gantry.start_);
     logicam = comp.getter_logicam_callback();
-    order_call = comp.getter_part_callback();
-    or_details[0] = order_call[0];
-    int on_table_1 = 0, on_table_2 = 0, new_order = 0, index = 0, part_on_belt = 0;
+    OrderBook &order_book = comp.getter_order_book();
+    size_t order_feed = 0;
+    int on_table_1 = 0, on_table_2 = 0, index = 0, part_on_belt = 0;
     auto gap_id = comp.check_gaps();
+
+    // Plans from previous runs are only valid for the same shelf layout
+    std::string plan_library_path;
+    ros::param::param<std::string>("~plan_library", plan_library_path,
+                                   std::string(getenv("HOME") ? getenv("HOME") : ".") + "/.ros/FP_group2_plans.bin");
+    gantry.openPlanLibrary(plan_library_path, PlanLibrary::hashValues(
+            {double(comp.gap_nos[0]), double(comp.gap_nos[1]), double(comp.gap_nos[2])}, 1.0));
+
+    // Height offsets learnt in previous runs
+    std::string calibration_path;
+    ros::param::param<std::string>("~calibration", calibration_path,
+                                   std::string(getenv("HOME") ? getenv("HOME") : ".") + "/.ros/FP_group2_calibration.txt");
+    OffsetCalibration calibration;
+    if (!calibration.load(calibration_path))
+        ROS_INFO_STREAM("[main] no calibration in " << calibration_path << " yet, starting from the defaults");
     int x_loop = 0, check = 0;
-    int on_belt = 0;
+    int on_belt = 0, belt_checked_orders = 0;
     std::array<std::array<int, 3>, 5> belt_part_arr = {0};
     comp.HumanDetection();
 
+    // People in the aisles: the trial's aisle_layout, which FP.launch loads into ~aisle_layout, corrected by the breakbeams
+    XmlRpc::XmlRpcValue aisle_layout;
+    if (ros::param::get("~aisle_layout", aisle_layout) && aisle_layout.getType() == XmlRpc::XmlRpcValue::TypeStruct)
+    {
+        auto number = [](XmlRpc::XmlRpcValue &value) {
+            return value.getType() == XmlRpc::XmlRpcValue::TypeInt ? double(int(value)) : double(value);
+        };
+        for (auto &person : aisle_layout)
+        {
+            int aisle = AislePredictor::aisleAt(number(person.second["location"]));
+            aisles.configure(aisle, number(person.second["start_time"]), number(person.second["move_time"]),
+                             number(person.second["wait_time"]));
+            ROS_INFO_STREAM("[main] " << person.first << " walks in aisle " << aisle + 1);
+        }
+    }
+    AisleMonitor aisle_monitor(comp.breakbeams(), aisles);
+    aisle_monitor.start(comp.humans());
+
     // Initialization of variables and functions for move to preset location
     std::map <std::string, std::vector<PresetLocation>> presetLocation;
     std::string location;
     double loc_x, loc_y;
-    gantry.initialPositions(presetLocation, comp.gap_nos, comp.Human, comp.Human_detected);
+    gantry.initialPositions(presetLocation, comp.gap_nos, comp.humans(), comp.humanDetected());
+    std::array<int, 4> routed_around = comp.humans();    //aisles the current routes avoid
     ROS_INFO_STREAM("\nGap print:");
     for (auto i1=0; i1<3; i1++)
     {
         ROS_INFO_STREAM("\ngap "<<i1+1<<" "<<comp.gap_nos[i1]);
     }
 
-    comp.PartonBeltCheck(comp.received_orders_, x_loop, logicam, belt_part_arr, on_belt);
+    comp.PartonBeltCheck(order_book, belt_checked_orders, x_loop, logicam, belt_part_arr, on_belt);
+
+    // Every announced shipment becomes pick/place tasks, later (high-priority) orders first
+    TaskScheduler scheduler;
+    PartSelector selector;
+    PickSequencer sequencer(selector);
+    BeltInterceptor interceptor(BELT_SPEED);
+    StagingBuffer staging;
+    int direct_placements = 0;
+    double direct_savings = 0.0;
+
+    // Instead of idling at start or coming back empty, wait over the bins the next products are likely in
+    bool preposition_enabled = true;
+    ros::param::param<bool>("~preposition", preposition_enabled, true);
+    RegionPredictor predictor;
+    int waiting_at = -1;
+    auto preposition = [&]() {
+        if (!preposition_enabled)
+            return -1;
+        std::vector<std::vector<int>> cameras;
+        for (auto &task : scheduler.upcoming(REGION_LOOKAHEAD))
+        {
+            cameras.emplace_back();
+            auto &type = order_book.product(task.product_id).type;
+            for (int x = 0; x < 17; x++)
+            {
+                if (x == 10 || x == 11 || x == 12)      // AGV trays and belt
+                    continue;
+                for (int y = 0; y < 36; y++)
+                    if (logicam[x][y].type == type && logicam[x][y].Shifted == false)
+                    {
+                        cameras.back().push_back(x);
+                        break;
+                    }
+            }
+        }
+        int camera = predictor.predict(cameras);
+        if (camera >= 0)
+        {
+            ROS_INFO_STREAM("\n Waiting over the bins of camera " << camera << " for the next pick");
+            gantry.goToPresetLocation(gantry.cameraStation(camera));
+        }
+        return camera;
+    };
+    //systematic placement error per arm, AGV and part type, learnt from the tray cameras
+    PlacementCorrector corrector;
+
+    //place leg: a move to the tray that fails is tried once more from start_
+    auto reachTray = [&gantry](const std::string &agv) {
+        PresetLocation tray = agv == "agv1" ? gantry.agv1_ : gantry.agv2_;
+        if (gantry.goToPresetLocation(tray) == MOVE_SUCCESS)
+            return true;
+        gantry.goToPresetLocation(gantry.start_);
+        return gantry.goToPresetLocation(tray) == MOVE_SUCCESS;
+    };
+
+    //faulty part on a tray: reach it from the quadrant preset it lies in, drop it on the way to where the gantry goes next
+    //returns false, with the part left on the tray, when it could not be picked
+    DisposalPlanner disposal;
+    auto disposeFaulty = [&gantry, &disposal](const part &faulty, const std::string &agv, const std::vector<point2> &next) {
+        ROS_INFO_STREAM("\n Pose for Faulty part " << faulty.pose);
+        bool picked = false;
+        if (agv == "agv2")
+        {
+            gantry.goToPresetLocation(gantry.agv2f_);
+            auto agv_faulty = gantry.agv2_;
+            if (faulty.pose.position.x > 0 && faulty.pose.position.y < -7.26)
+            {
+                ROS_INFO_STREAM("Faulty part at Left top of tray!!");
+                agv_faulty = gantry.agv2flt_;
+            }
+            else if (faulty.pose.position.x > 0 && faulty.pose.position.y > -7.26)
+            {
+                ROS_INFO_STREAM("Faulty part at Left bottom of tray!!");
+                agv_faulty = gantry.agv2flb_;
+            }
+            else if (faulty.pose.position.x < 0 && faulty.pose.position.y < -7.26)
+            {
+                ROS_INFO_STREAM("Faulty part at Right top of tray!!");
+                agv_faulty = gantry.agv2frt_;
+            }
+            else if (faulty.pose.position.x < 0 && faulty.pose.position.y > -7.26)
+            {
+                ROS_INFO_STREAM("Faulty part at Right bottom of tray!!");
+                agv_faulty = gantry.agv2frb_;
+            }
+            gantry.goToPresetLocation(agv_faulty);
+            picked = gantry.pickPart(faulty);
+            gantry.goToPresetLocation(agv_faulty);
+        }
+        else if (agv == "agv1")
+        {
+            gantry.goToPresetLocation(gantry.agv1f_);
+            auto agv_faulty = gantry.agv1_;
+            if (faulty.pose.position.x < 0 && faulty.pose.position.y > 7.12)
+            {
+                ROS_INFO_STREAM("Faulty part at Left top of tray!!");
+                agv_faulty = gantry.agv1flt_;
+            }
+            else if (faulty.pose.position.x < 0 && faulty.pose.position.y < 7.12)
+            {
+                ROS_INFO_STREAM("Faulty part at Left bottom of tray!!");
+                agv_faulty = gantry.agv1flb_;
+            }
+            else if (faulty.pose.position.x > 0 && faulty.pose.position.y > 7.12)
+            {
+                ROS_INFO_STREAM("Faulty part at Right top of tray!!");
+                agv_faulty = gantry.agv1frt_;
+            }
+            else if (faulty.pose.position.x > 0 && faulty.pose.position.y < 7.12)
+            {
+                ROS_INFO_STREAM("Faulty part at Right bottom of tray!!");
+                agv_faulty = gantry.agv1frb_;
+            }
+            gantry.goToPresetLocation(agv_faulty);
+            picked = gantry.pickPart(faulty);
+            gantry.goToPresetLocation(agv_faulty);
+        }
+        if (!picked)
+        {
+            gantry.deactivateGripper("left_arm");
+            return false;
+        }
+        int drop = disposal.plan(gantry.getGantryPosition(), next);
+        ROS_INFO_STREAM("\n Dropping faulty part at (" << disposal.drop(drop).position.x << ", "
+                        << disposal.drop(drop).position.y << ")");
+        gantry.goToPresetLocation(gantry.dropStation(drop));
+        gantry.deactivateGripper("left_arm");
+        return true;
+    };
+
+    //placements waiting for their quality verdict; a failed one is disposed of and its product placed again
+    typedef struct Verification {
+        Task task;
+        std::string agv;
+        std::future<QcSlot> verdict;
+    } verification;
+    std::vector<Verification> verifying;
+    int chained_to = -1;    //bin camera the gantry went to straight from a faulty part drop
+    auto remediate = [&](const std::string &agv, bool wait) {
+        for (auto pending = verifying.begin(); pending != verifying.end(); )
+        {
+            if (pending->agv != agv || !(wait || pending->verdict.wait_for(std::chrono::seconds(0)) == std::future_status::ready))
+            {
+                ++pending;
+                continue;
+            }
+            QcSlot verdict = pending->verdict.get();
+            if (verdict.status == QC_PENDING && verdict.task.product_id >= 0)
+                ROS_WARN_STREAM("\n No quality control message for " << agv << " in " << QC_VERDICT_TIMEOUT << " s, assuming good");
+            pending = verifying.erase(pending);
+        }
+        //every faulty part on the tray in one pass, including ones flagged after their own verdict
+        //a part that could not be picked stays in its slot and holds the shipment back until a later pass takes it
+        int reopened = 0, stuck = 0;
+        for (auto &slot : comp.quality().faulty(agv))
+        {
+            if (slot.task.product_id >= 0 && comp.quality().verdict(agv, slot.task.product_id).status != QC_FAULTY)
+                continue;
+            ROS_INFO_STREAM("Faulty " << slot.detection.type << " on " << agv << ", product "
+                            << slot.task.product_id << ", seen since " << slot.detection.first_seen);
+            part faulty;
+            faulty.type = slot.detection.type;
+            faulty.pose = slot.detection.pose;
+            faulty.pose.position.z = slot.target.position.z;
+
+            //its replacement runs next: if one is in the bins, drop on the way and wait there
+            std::vector<point2> next = {START_POSITION};
+            int chain_camera = -1;
+            for (int x = 0; x < NUMBER_OF_BIN_CAMERAS && chain_camera < 0; x++)
+                for (int y = 0; y < 36; y++)
+                    if (logicam[x][y].type == faulty.type && logicam[x][y].Shifted == false)
+                    {
+                        chain_camera = x;
+                        auto station = gantry.cameraStation(x);
+                        next = {{station.gantry[0], -station.gantry[1]}};
+                        break;
+                    }
+            if (!disposeFaulty(faulty, agv, next))
+            {
+                ROS_WARN_STREAM("\n Could not pick the faulty " << faulty.type << " off " << agv
+                                << ", leaving it for the next pass");
+                stuck++;
+                continue;
+            }
+            comp.quality().removed(agv, slot.task.product_id);
+            if (chain_camera >= 0)
+            {
+                gantry.goToPresetLocation(gantry.cameraStation(chain_camera));
+                chained_to = chain_camera;
+            }
+            if (slot.task.product_id >= 0 && scheduler.isComplete(slot.task.product_id))
+            {
+                scheduler.reopen(slot.task);
+                reopened++;
+            }
+        }
+        return reopened + stuck;
+    };
+    auto beltSighting = [&comp]() {
+        auto camera = comp.getter_logicam_callback()[12][0];
+        return BeltSighting{camera.type, camera.pose.position.y, camera.time_stamp.toSec()};
+    };
+    std::set<int> announced;
+    for (auto &shipment : order_book.changesSince(order_feed)) {
+        scheduler.addShipment(shipment.order, shipment.shipment, shipment.first_product, shipment.product_count, shipment.order);
+        announced.insert(shipment.order);
+    }
+    comp.PartonBeltCheck(order_book, belt_checked_orders, 0, logicam, belt_part_arr, on_belt);
+    for (auto priority : announced)
+        sequenceTasks(scheduler, priority, order_book, logicam, gantry.getGantryPosition(),
+                      aisle_monitor.blocked(ros::Time::now().toSec()), sequencer);
+    waiting_at = preposition();
+
+    Task current;
+    while (scheduler.next(current)) {
+        int i = current.order, j = current.shipment, k = current.product;
+        int count = 0;
+        ROS_INFO_STREAM("\n Task: order=" << i << ", shipment=" << j << ", product=" << k << ", priority=" << current.priority);
+
+        //a belt product with no part in sight yet: wait for it (bounded) rather than search the bins
+        bool belt_task = false;
+        for (int p = part_on_belt; p < on_belt; p++)
+            belt_task |= belt_part_arr[p][0] == i && belt_part_arr[p][1] == j && belt_part_arr[p][2] == k;
+        //sleep until a part crosses breakbeam 0, watch camera 12 only while one is on its way to it
+        if (belt_task)
+        {
+            ros::Time wait_until = ros::Time::now() + ros::Duration(BELT_WAIT_TIMEOUT);
+            ros::Rate poll(10);
+            for (auto seen = beltSighting(); seen.type.empty() || !interceptor.isNew(seen); seen = beltSighting())
+            {
+                double remaining = (wait_until - ros::Time::now()).toSec();
+                if (remaining <= 0)
+                    break;
+                if ((ros::Time::now() - comp.breakbeams().lastRising(BELT_BREAKBEAM)).toSec() > BELT_BEAM_TO_CAMERA_TIME)
+                    comp.breakbeams().waitForEdge(BELT_BREAKBEAM, BEAM_RISING, remaining);
+                else
+                    poll.sleep();
+            }
+        }
+        logicam12 = comp.getter_logicam_callback();
+        ROS_INFO_STREAM("\n Print i=" << i << ", j=" << j << ", k=" << k);
+        ROS_INFO_STREAM("\n Print order_book.orderCount()=" << order_book.orderCount());
+        ROS_INFO_STREAM("\n Print order_book.shipmentCount(i)=" << order_book.shipmentCount(i));
+        ROS_INFO_STREAM("\n Print order_book.productCount(i, j)=" << order_book.productCount(i, j));
+        ROS_INFO_STREAM("\n AGV ID: " << order_book.product(i, j, k).agv_id);
+        ROS_INFO_STREAM("\n Order shipment name: " << order_book.product(i, j, k).shipment);
+//                ROS_INFO_STREAM("\n parts on_belt : " << on_belt);
 
-    for (int i = comp.received_orders_.size() - 1; i >= 0; --i) {
-        if (completed2[i]==1)
+        //part on the belt: go straight to where its predicted path meets the gantry, then take it to the AGV
+        //if the current product needs it, otherwise stage it in a bin
+        BeltSighting sighting = beltSighting();
+        bool held_from_belt = false;
+        ros::Time belt_grasped;
+        double staged_estimate = 0.0, direct_estimate = 0.0;    //travel model of PartSelector, s
+        if (part_on_belt < on_belt && !sighting.type.empty() && interceptor.isNew(sighting))
         {
+            PresetLocation station = gantry.beltStation(sighting.type);
+            Intercept intercept = interceptor.plan(sighting, {station.gantry[0], -station.gantry[1]},
+                                                   ros::Time::now().toSec(), gantry.getGantryPosition());
+            //same arm configuration, the gantry meets the part where it can reach it
+            station.gantry[1] = -(intercept.y - BELT_GRASP_OFFSET_Y);
+            ROS_INFO_STREAM("\n Belt " << sighting.type << " seen at y=" << sighting.y << ", grasped at y=" << intercept.y
+                            << " in " << intercept.arrival_time - ros::Time::now().toSec() << " s, slack "
+                            << intercept.slack << " s");
+            bool grasped = false;
+            if (intercept.feasible)
+            {
+                waiting_at = -1;
+                grasped = gantry.graspFromBelt(station, ros::Time(intercept.grasp_time),
+                                               ros::Time(intercept.arrival_time + BELT_GRASP_WINDOW));
+            }
+            else
+                ROS_WARN_STREAM("\n Belt part passes before the gantry can get there, leaving it for its next cycle");
+            interceptor.record(sighting, intercept, grasped);
+
+            part &needed = order_book.product(i, j, k);
+            std::string needed_agv = ExecutivePolicy::assignedAgv(needed.agv_id, j);
+            point2 needed_position = needed_agv == "agv1" ? AGV1_POSITION : AGV2_POSITION;
+            point2 station_position = {station.gantry[0], -station.gantry[1]};
+            if (grasped && ExecutivePolicy::placeDirectly(sighting.type, needed.type, scheduler.isComplete(current.product_id),
+                                                          dispatcher.available(needed_agv == "agv1" ? 1 : 2),
+                                                          station_position, needed_position))
+            {
+                int bin = staging.nearest(needed_position, binInventory(logicam));
+                point2 bin_position = bin ? staging.slot(bin).center : station_position;
+                staged_estimate = PartSelector::legTime(station_position, bin_position) + PICK_PLACE_TIME
+                                  + PartSelector::legTime(bin_position, needed_position);
+                direct_estimate = PartSelector::legTime(station_position, needed_position);
+                belt_grasped = ros::Time::now();
+                held_from_belt = true;
+                part_on_belt++;
+                logicam[12][0].type = sighting.type;
+                logicam[12][0].pose.position.x = station_position.x;
+                logicam[12][0].pose.position.y = interceptor.positionAt(sighting, intercept.arrival_time);
+                logicam[12][0].time_stamp = belt_grasped;
+                logicam[12][0].Shifted = false;
+                ROS_INFO_STREAM("\n Belt part needed now, placing it straight on " << needed_agv);
+                gantry.goToPresetLocation(gantry.belta_);
+            }
+            else if (grasped)
+            {
+                gantry.goToPresetLocation(gantry.belta_);
+                gantry.goToPresetLocation(gantry.start_);
+
+                auto i1 = belt_part_arr[part_on_belt][0];
+                auto j1 = belt_part_arr[part_on_belt][1];
+                auto k1 = belt_part_arr[part_on_belt][2];
+
+                order_book.product(i1, j1, k1).agv_id = ExecutivePolicy::assignedAgv(order_book.product(i1, j1, k1).agv_id, j1);
+                int bin = staging.reserve(order_book.product(i1, j1, k1).agv_id == "agv1" ? AGV1_POSITION : AGV2_POSITION,
+                                          binInventory(logicam));
+                if (bin == 0)
+                    ROS_WARN_STREAM("\n No free bin to stage the belt part, using bin " << STAGING_FALLBACK_BIN);
+                bin = ExecutivePolicy::stagingBin(bin);
+                gantry.goToPresetLocation(gantry.binStation(bin));
+                gantry.deactivateGripper("left_arm");
+                registerStagedPart(logicam, comp.getter_logicam_callback(), staging.slot(bin), sighting.type);
+                part_on_belt++;
+                ROS_INFO_STREAM("\n Belt part staged in bin " << bin << ", " << staging.freeSlots(binInventory(logicam))
+                                << " bins left free");
+                gantry.goToPresetLocation(gantry.start1_);
+            }
+        }
+        if (scheduler.isComplete(current.product_id))
             continue;
+
+        order_book.product(i, j, k).agv_id = ExecutivePolicy::assignedAgv(order_book.product(i, j, k).agv_id, j);
+
+        //every free instance of the part, cheapest round trip (gantry -> part -> AGV) first
+        std::vector<Candidate> candidates;
+        for (int x = 0; x < 17; x++)
+        {
+            if (x == 10 || x == 11 || x == 12)      // AGV trays and belt
+                continue;
+            for (int y = 0; y < 36; y++)
+                if (logicam[x][y].type == order_book.product(i, j, k).type && logicam[x][y].Shifted == false)
+                    candidates.push_back({x, y, {logicam[x][y].pose.position.x, logicam[x][y].pose.position.y}, 0.0});
         }
-        for (int j = 0; j < comp.received_orders_[i].shipments.size(); j++) {
-            if (completed2[i] == 1)
-                break;
-            for (int k = 0; k < comp.received_orders_[i].shipments[j].products.size(); k++)
-            {
-                ROS_INFO_STREAM("\nIN k loop..");
-                int count = 0, count1 = 0;
-                ROS_INFO_STREAM("\n Print i="<<i<<", j="<<j<<", k="<<k);
-                ROS_INFO_STREAM("\n Print comp.received_orders_.size()="<<comp.received_orders_.size());
-                ROS_INFO_STREAM("\n Print comp.received_orders_[i].shipments.size()="<<comp.received_orders_[i].shipments.size());
-                ROS_INFO_STREAM("\n Print comp.received_orders_[i].shipments[j].products.size()="<<comp.received_orders_[i].shipments[j].products.size());
-                ROS_INFO_STREAM("\n AGV ID: "<<or_details[i][j][k].agv_id);
-                ROS_INFO_STREAM("\n Order shipment name: "<<or_details[i][j][k].shipment);
-                if (new_order)
-                {
-                    new_order = 0;
-                    j=0;
-                    k=0;
-                }
-                for (auto l = 0; l < comp.received_orders_[i].shipments[j].products.size(); l++)
+        //routes and ranking follow the people as they move, not the startup snapshot
+        auto blocked = aisle_monitor.blocked(ros::Time::now().toSec());
+        if (blocked != routed_around)
+        {
+            bool any_blocked = std::count(blocked.begin(), blocked.end(), 1) > 0;
+            gantry.initialPositions(presetLocation, comp.gap_nos, blocked, any_blocked);
+            routed_around = blocked;
+            ROS_INFO_STREAM("\n Routes re-selected, avoiding aisles " << blocked[0] << blocked[1] << blocked[2] << blocked[3]);
+        }
+        selector.rank(candidates, gantry.getGantryPosition(),
+                      order_book.product(i, j, k).agv_id == "agv1" ? AGV1_POSITION : AGV2_POSITION, blocked);
+        if (held_from_belt)     //already in the gripper, camera 12 stands for the belt
+            candidates.insert(candidates.begin(), {12, 0, {logicam[12][0].pose.position.x, logicam[12][0].pose.position.y}, 0.0});
+
+        for (auto &candidate : candidates)
+        {
+            int x = candidate.camera, y = candidate.slot;
+            if (logicam[x][y].Shifted == false) {
+                ROS_INFO_STREAM("\n Estimated round trip: " << candidate.cost << " s");
+                ROS_INFO_STREAM("\n\nPart being taken " << logicam[x][y].type);
+                ROS_INFO_STREAM("\n\nlogical camera: " << x);
+                bool from_belt = x == 12;
+                bool over_bins = waiting_at >= 0 || chained_to >= 0;
+                predictor.record(waiting_at, x);
+                waiting_at = -1;
+                chained_to = -1;
+                if (ExecutivePolicy::routeViaStart(x, over_bins, from_belt))
+                    gantry.goToPresetLocation(gantry.start_);
+
+//                            ROS_INFO_STREAM("\n Test run of move to preset location function.");
+                location = logicam[x][y].frame;
+                auto location1 = logicam[x][y].frame;
+                ROS_INFO_STREAM("X POSITION " << logicam[x][y].pose.position.x);
+                ROS_INFO_STREAM("Y POSITION " << logicam[x][y].pose.position.y);
+                ROS_INFO_STREAM("Z POSITION " << logicam[x][y].pose.position.z);
+                ROS_INFO_STREAM("Location: " << location);
+                auto target_pose = gantry.getTargetWorldPose(order_book.product(i, j, k).pose, "agv1");
+                loc_x = logicam[x][y].pose.position.x;
+                loc_y = logicam[x][y].pose.position.y;
+                //shelf part: reach the aisle entry just as the person in it is predicted to be out of the way,
+                //go around through the shelf gaps if that does not happen soon enough
+                int aisle = PartSelector::aisleOf(candidate.position);
+                if (!from_belt && aisles.known(aisle))
                 {
-                    if (order_flag[i][j][l] == 1)
-                        count1++;
+                    double now = ros::Time::now().toSec();
+                    double to_entry = PartSelector::legTime(gantry.getGantryPosition(), {AISLE_ENTRY_X, AISLE_Y[aisle]});
+                    double in_aisle = 2 * std::fabs(candidate.position.x - AISLE_ENTRY_X) / GANTRY_SPEED_X + AISLE_PICK_TIME;
+                    ClearWindow window = aisles.nextClear(aisle, now + to_entry, in_aisle);
+                    if (window.feasible && window.start - (now + to_entry) <= AISLE_MAX_WAIT)
+                    {
+                        ROS_INFO_STREAM("\n Aisle " << aisle + 1 << " clear in " << window.start - now << " s, for "
+                                                     << window.end - window.start << " s, " << to_entry << " s away");
+                        if (window.start - to_entry > now)
+                            ros::Duration(window.start - to_entry - now).sleep();
+                    }
+                    else if (!routed_around[aisle])
+                    {
+                        ROS_INFO_STREAM("\n Aisle " << aisle + 1 << " not clear in time, going around it");
+                        routed_around[aisle] = 1;
+                        gantry.initialPositions(presetLocation, comp.gap_nos, routed_around, true);
+                    }
                 }
-                if (count1 == comp.received_orders_[i].shipments[j].products.size())
+                if (!from_belt)
                 {
-                    ROS_INFO_STREAM("shipment j=" << j << "completed..");
-                    if (or_details[i][j][k].agv_id == "agv1")
+                    gantry.takeMoveFailure();
+                    gantry.moveToPresetLocation(presetLocation, location, loc_x, loc_y, 1, logicam[x][y].type,comp.gap_nos, comp);
+                    MoveStatus reached = gantry.takeMoveFailure();
+                    if (reached != MOVE_SUCCESS)
                     {
-                        ROS_INFO_STREAM("\n Submitting Order: " << or_details_new[i][j][k].shipment);
-                        submitOrder(1, or_details[i][j][k].shipment);
+                        ROS_WARN_STREAM("\n Could not reach the " << logicam[x][y].type << " at " << location << ": "
+                                        << move_status_name[reached] << ", trying the next candidate");
+                        gantry.goToPresetLocation(gantry.start_);
+                        continue;
                     }
-                    else if (or_details[i][j][k].agv_id == "agv2")
+                }
+                ROS_INFO_STREAM("update Location: " << location);
+                part my_part;
+                my_part.type = logicam[x][y].type;
+                my_part.pose = logicam[x][y].pose;
+                //height error learnt for this pick location: per bin, per camera on the shelves
+                int bin = staging.binAt(candidate.position);
+                std::string pick_location = bin ? OffsetCalibration::binLocation(bin) : OffsetCalibration::cameraLocation(x);
+                my_part.pose.position.z += calibration.graspOffset(pick_location);
+
+                if (!from_belt)
+                {
+                    ros::Duration(1).sleep();
+                    bool picked = gantry.pickPart(my_part);
+                    if (picked)
+                        calibration.observeGrasp(pick_location, gantry.pickLowering());
+                    ros::Duration(1).sleep();
+                    gantry.moveToPresetLocation(presetLocation, location1, loc_x, loc_y, 2, logicam[x][y].type,comp.gap_nos, comp);
+                    if (!picked)
                     {
-                        ROS_INFO_STREAM("\n Submitting Order: " << or_details_new[i][j][k].shipment);
-                        submitOrder(2, or_details[i][j][k].shipment);
+                        ROS_WARN_STREAM("\n " << my_part.type << " at " << location << " did not attach, trying the next candidate");
+                        gantry.deactivateGripper("left_arm");
+                        logicam[x][y].Shifted = true;
+                        gantry.goToPresetLocation(gantry.start_);
+                        continue;
                     }
                 }
-                if (order_flag[i][j][k] != 0)
+                ROS_INFO_STREAM("GOING TO START JUST TO BE SAFE!!!!!!");
+                gantry.goToPresetLocation(gantry.start_);
+                ROS_INFO_STREAM("Approaching AGV's to place object!!!");
+                //pre-compensate what this arm usually misses by on this AGV
+                std::string place_arm = order_book.product(i, j, k).pose.orientation.x != 0 ? "right_arm" : "left_arm";
+                point2 correction = corrector.correction(place_arm, order_book.product(i, j, k).agv_id, my_part.type);
+                if (!reachTray(order_book.product(i, j, k).agv_id))
+                {
+                    ROS_ERROR_STREAM("\n " << order_book.product(i, j, k).agv_id << " unreachable, dropping the "
+                                     << my_part.type << " and trying the next candidate");
+                    gantry.goToPresetLocation(gantry.dropStation(0));
+                    gantry.deactivateGripper("left_arm");
+                    logicam[x][y].Shifted = true;
                     continue;
+                }
+                if (order_book.product(i, j, k).agv_id == "agv1") {
+                    ROS_INFO_STREAM("\n Waypoint AGV1 reached\n");
+                    if (order_book.product(i, j, k).pose.orientation.x != 0) {
+                        ROS_INFO_STREAM("Part is to be flipped");
+                        gantry.goToPresetLocation(gantry.agv1c_);
+                        ROS_INFO_STREAM("\n Waypoint AGV1 reached\n");
+                        gantry.goToPresetLocation(gantry.agv1flipa_);
+                        gantry.activateGripper("right_arm");
+                        ros::Duration(0.2).sleep();
+                        gantry.deactivateGripper("left_arm");
+                        ROS_INFO_STREAM("Part flipped");
+                        order_book.product(i, j, k).pose.orientation.x = 0.0;
+                        order_book.product(i, j, k).pose.orientation.y = 0;
+                        order_book.product(i, j, k).pose.orientation.z = 0.0;
+                        order_book.product(i, j, k).pose.orientation.w = 1;
+                        gantry.goToPresetLocation(gantry.agv1flipb_);
+                        gantry.placePartRight(order_book.product(i, j, k), "agv1", correction);
+                        ROS_INFO_STREAM("\n Object placed!!!!!!!!!!\n");
+                        gantry.goToPresetLocation(gantry.agv1_);
+                    } else
+                        gantry.placePart(order_book.product(i, j, k), "agv1", correction);
+                    logicam[x][y].Shifted = true;
+                } else if (order_book.product(i, j, k).agv_id == "agv2") {
+                    ROS_INFO_STREAM("\n Waypoint AGV2 reached\n");
+                    if (order_book.product(i, j, k).pose.orientation.x != 0) {
+                        ROS_INFO_STREAM("Part is to be flipped");
+                        gantry.goToPresetLocation(gantry.agv2a_);
+                        ROS_INFO_STREAM("\n Waypoint AGV2 reached\n");
+                        gantry.activateGripper("right_arm");
+                        ros::Duration(0.2).sleep();
+                        gantry.deactivateGripper("left_arm");
+                        ROS_INFO_STREAM("Part flipped");
+                        order_book.product(i, j, k).pose.orientation.x = 0.0;
+                        order_book.product(i, j, k).pose.orientation.y = 0;
+                        order_book.product(i, j, k).pose.orientation.z = 0.0;
+                        order_book.product(i, j, k).pose.orientation.w = 1;
+                        gantry.goToPresetLocation(gantry.agv2b_);
+                        gantry.placePartRight(order_book.product(i, j, k), "agv2", correction);
+                        ROS_INFO_STREAM("\n Object placed!!!!!!!!!!\n");
+                        gantry.goToPresetLocation(gantry.agv2_);
+                    } else
+                        gantry.placePart(order_book.product(i, j, k), "agv2", correction);
+                    logicam[x][y].Shifted = true;
+                    target_pose = gantry.getTargetWorldPose(order_book.product(i, j, k).pose, "agv2");
+                }
 
-                if (part_on_belt==0 && on_belt!=0)
+                //Checking to erase in next logicam matrix..
+                for (int y1=0; y1<36; y1++)
                 {
-                    ROS_INFO_STREAM("Waiting for part to spawn on belt!!");
-                    do {
-                        //
-                    }while(comp.beam_detect[0]==false);
+                    if (x==Max_number_of_cameras-1)
+                        break;
+                    else if((abs(logicam[x][y].pose.position.x - logicam[x+1][y1].pose.position.x) < 0.01) && (abs(logicam[x][y].pose.position.y - logicam[x+1][y1].pose.position.y) < 0.01)) {
+                        ROS_INFO_STREAM("\n Common part for 2 cameras, marking as completed for next iteration!");
+                        logicam[x + 1][y1].Shifted = true;
+                    }
                 }
-                logicam12 = comp.getter_logicam_callback();
-                ROS_INFO_STREAM("\n Print i=" << i << ", j=" << j << ", k=" << k);
-                ROS_INFO_STREAM("\n Print comp.received_orders_.size()=" << comp.received_orders_.size());
-                ROS_INFO_STREAM("\n Print comp.received_orders_[i].shipments.size()="
-                                        << comp.received_orders_[i].shipments.size());
-                ROS_INFO_STREAM("\n Print comp.received_orders_[i].shipments[j].products.size()="
-                                        << comp.received_orders_[i].shipments[j].products.size());
-                ROS_INFO_STREAM("\n AGV ID: " << or_details[i][j][k].agv_id);
-                ROS_INFO_STREAM("\n Order shipment name: " << or_details[i][j][k].shipment);
-//                ROS_INFO_STREAM("\n parts on_belt : " << on_belt);
 
-                //loop to pick up part from belt and place in bins 9 and 14 if required
-                if ((part_on_belt < on_belt) && (comp.beam_detect[0]==true || !logicam12[12][0].type.empty()))
+                logicam2 = comp.getter_logicam_callback();
+                ROS_INFO_STREAM("\n After placing.");
+                ROS_INFO_STREAM("\n order name: "<<order_book.product(i, j, k).type);
+                ROS_INFO_STREAM("\n order details: "<<order_book.product(i, j, k).pose);
+                ROS_INFO_STREAM("\n Target pose: "<<target_pose);
+                auto cam = logicam2[10][on_table_1].pose;
+                if (order_book.product(i, j, k).agv_id=="agv1")
                 {
-                    on_belt = 2;
-                    do
-                        {
-                        if (part_on_belt!=0)
+                    for (auto ill=0; ill<=on_table_1; ill++)
+                    {
+                        if (logicam2[10][ill].type == order_book.product(i, j, k).type && abs(logicam2[10][ill].pose.position.x-target_pose.position.x)<0.1 && abs(logicam2[10][ill].pose.position.y-target_pose.position.y)<0.1)
                         {
-                            ROS_INFO_STREAM("Waiting for part to spawn on belt!!");
-                            do {
-                                //
-                            }while(comp.beam_detect[0]==false);
+                            ROS_INFO_STREAM("\n Printing agv1 index value: "<<ill<<"\n Also product type = "<<logicam2[10][ill].type);
+                            index=ill;
+                            break;
                         }
-                        ROS_INFO_STREAM("\n Picking part from belt");
-                        gantry.goToPresetLocation(gantry.belta_);
-                        ROS_INFO_STREAM("\nWaiting for beam to turn off");
-                        do {
-                           //
-                        } while (comp.beam_detect[0] == true);
-                        logicam12 = comp.getter_logicam_callback();
-                        if (part_on_belt!=0)
+                    }
+                    ROS_INFO_STREAM("\n AGV camera details: "<<logicam2[10][index].pose);
+                    cam = logicam2[10][index].pose;
+                }
+                else if (order_book.product(i, j, k).agv_id=="agv2")
+                {
+                    for (auto ill=0; ill<=on_table_2; ill++)
+                    {
+                        if (logicam2[11][ill].type == order_book.product(i, j, k).type && abs(logicam2[11][ill].pose.position.x-target_pose.position.x)<0.1 && abs(logicam2[11][ill].pose.position.y-target_pose.position.y)<0.1)
                         {
-                            ros::Duration(2).sleep();
+                            ROS_INFO_STREAM("\n Printing agv2 index value: "<<ill<<"\n Also product type = "<<logicam2[11][ill].type);
+                            index=ill;
+                            break;
                         }
-                        ROS_INFO_STREAM("\nWaiting to be detected by camera..");
-                        do
-                        {
-                            logicam12 = comp.getter_logicam_callback();
-                        }while(logicam12[12][0].type.empty());
-                        ROS_INFO_STREAM("\n Detected by camera. Trying to pick up!!");
-                        ros::Duration(0.2).sleep();
-                        part belt_part;
-                        belt_part.pose = logicam12[12][0].pose;
-                        belt_part.type = logicam12[12][0].type;
-                        if (logicam12[12][0].type == "piston_rod_part_red" || logicam12[12][0].type == "piston_rod_part_green" || logicam12[12][0].type == "piston_rod_part_blue")
+                    }
+                    ROS_INFO_STREAM("\n AGV camera details: "<<logicam2[11][index].pose);
+                    cam = logicam2[11][index].pose;
+                }
+                //quality verdict comes later through a future, the next pick does not wait for it
+                auto &agv = order_book.product(i, j, k).agv_id;
+                comp.quality().placed(agv, current, target_pose, ros::Time::now());
+                verifying.push_back({current, agv, comp.quality().verdictAsync(agv, current.product_id, QC_VERDICT_TIMEOUT)});
+                ROS_INFO_STREAM("\n X offset: "<<abs(cam.position.x-target_pose.position.x));
+                ROS_INFO_STREAM("\n Y offset: "<<abs(cam.position.y-target_pose.position.y));
+
+                //the tray camera against the target it was placed at, when it did see the part
+                int tray_camera = agv == "agv1" ? 10 : 11;
+                if (abs(cam.position.x-target_pose.position.x) < 0.1 && abs(cam.position.y-target_pose.position.y) < 0.1)
+                    calibration.observeCamera(tray_camera, cam.position.z - target_pose.position.z);
+                bool misplaced = corrector.observe(place_arm, agv, my_part.type, {target_pose.position.x, target_pose.position.y},
+                                                   correction, {cam.position.x, cam.position.y});
+
+//Faulty pose correction
+                if (misplaced)
+                {
+                    if (abs(cam.position.x-target_pose.position.x)>PLACEMENT_TOLERANCE)
+                        ROS_INFO_STREAM("\n X offset detected");
+                    if (abs(cam.position.y-target_pose.position.y)>PLACEMENT_TOLERANCE)
+                        ROS_INFO_STREAM("\n Y offset detected");
+                    ROS_INFO_STREAM("\n Faulty Pose detected for part "<<logicam[x][y].type);
+                    faulty_pose.type = my_part.type;
+                    ROS_INFO_STREAM("\n Trying to compute path for "<<faulty_pose.type);
+                    ROS_INFO_STREAM("\n Faulty pose "<<cam);
+                    faulty_pose.pose = cam;
+                    faulty_pose.pose.position.z -= calibration.cameraOffset(tray_camera);
+                    if (order_book.product(i, j, k).agv_id=="agv2")
+                    {
+                        gantry.goToPresetLocation(gantry.agv2f_);
+                        ROS_INFO_STREAM("\n Reconfiguring for better pickup...");
+                        auto agv_faulty = gantry.agv2_;
+                        if (faulty_pose.pose.position.x > 0 && faulty_pose.pose.position.y < -7.26)
                         {
-                            gantry.goToPresetLocation(gantry.beltb1_);
-                            do
-                                {
-                                gantry.activateGripper("left_arm");
-                                ROS_INFO_STREAM("\n Trying to pick up!!");
-                            } while (!gantry.getGripperState("left_arm").attached);
-                            ros::Duration(1).sleep();
-                            gantry.goToPresetLocation(gantry.beltb1_);
-                            gantry.goToPresetLocation(gantry.belta_);
-                            gantry.goToPresetLocation(gantry.start_);
+                            ROS_INFO_STREAM("Faulty pose at Left top of tray!!");
+                            agv_faulty = gantry.agv2flt_;
                         }
-                        if (logicam12[12][0].type == "pulley_part_red" || logicam12[12][0].type == "pulley_part_green" || logicam12[12][0].type == "pulley_part_blue")
+                        else if (faulty_pose.pose.position.x > 0 && faulty_pose.pose.position.y > -7.26)
                         {
-                            gantry.goToPresetLocation(gantry.beltb2_);
-                            do
-                            {
-                                gantry.activateGripper("left_arm");
-                                ROS_INFO_STREAM("\n Trying to pick up!!");
-                            } while (!gantry.getGripperState("left_arm").attached);
-                            ros::Duration(1).sleep();
-                            gantry.goToPresetLocation(gantry.beltb2_);
-                            gantry.goToPresetLocation(gantry.belta_);
-                            gantry.goToPresetLocation(gantry.start_);
+                            ROS_INFO_STREAM("Faulty pose at Left bottom of tray!!");
+                            agv_faulty = gantry.agv2flb_;
                         }
-                        if (logicam12[12][0].type == "disk_part_red" || logicam12[12][0].type == "disk_part_green" || logicam12[12][0].type == "disk_part_blue")
+                        else if (faulty_pose.pose.position.x < 0 && faulty_pose.pose.position.y < -7.26)
                         {
-                            gantry.goToPresetLocation(gantry.beltc2_);
-                            do
-                            {
-                                gantry.activateGripper("left_arm");
-                                ROS_INFO_STREAM("\n Trying to pick up!!");
-                            } while (!gantry.getGripperState("left_arm").attached);
-                            ros::Duration(1).sleep();
-                            gantry.goToPresetLocation(gantry.beltc2_);
-                            gantry.goToPresetLocation(gantry.belta_);
-                            gantry.goToPresetLocation(gantry.start_);
+                            ROS_INFO_STREAM("Faulty pose at Right top of tray!!");
+                            agv_faulty = gantry.agv2frt_;
                         }
-                        if (logicam12[12][0].type == "gasket_part_red" || logicam12[12][0].type == "gasket_part_green" || logicam12[12][0].type == "gasket_part_blue")
+                        else if (faulty_pose.pose.position.x < 0 && faulty_pose.pose.position.y > -7.26)
                         {
-                            gantry.goToPresetLocation(gantry.beltd2_);
-                            do
-                            {
-                                gantry.activateGripper("left_arm");
-                                ROS_INFO_STREAM("\n Trying to pick up!!");
-                            } while (!gantry.getGripperState("left_arm").attached);
-                            ros::Duration(1).sleep();
-                            gantry.goToPresetLocation(gantry.beltd2_);
-                            gantry.goToPresetLocation(gantry.belta_);
-                            gantry.goToPresetLocation(gantry.start_);
+                            ROS_INFO_STREAM("Faulty pose at Right bottom of tray!!");
+                            agv_faulty = gantry.agv2frb_;
                         }
-
-                        auto i1 = belt_part_arr[part_on_belt][0];
-                        auto j1 = belt_part_arr[part_on_belt][1];
-                        auto k1 = belt_part_arr[part_on_belt][2];
-                        auto target_pose = gantry.getTargetWorldPose(or_details[i1][j1][k1].pose, "agv1");
-
-                        if (or_details[i1][j1][k1].agv_id == "any" && j1==0)
-                            or_details[i1][j1][k1].agv_id = "agv1";
-                        else if (or_details[i1][j1][k1].agv_id == "any" && j1!=0)
-                            or_details[i1][j1][k1].agv_id = "agv2";
-                        if (part_on_belt == 0)
+                        gantry.goToPresetLocation(agv_faulty);
+                        if (gantry.pickPart(faulty_pose))
                         {
-                            gantry.goToPresetLocation(gantry.bin9_);
-                            gantry.deactivateGripper("left_arm");
+                            ros::Duration(0.2).sleep();
+                            ROS_INFO_STREAM("\nPart Picked!");
+                            gantry.goToPresetLocation(gantry.agv2_);
+                            gantry.placePart(order_book.product(i, j, k), "agv2",
+                                             corrector.correction("left_arm", "agv2", my_part.type));
+                            ROS_INFO_STREAM("\n Placed!!!");
                         }
                         else
                         {
-                            gantry.goToPresetLocation(gantry.bin14_);
+                            ROS_WARN_STREAM("\n Could not pick the misplaced " << my_part.type << " up again, leaving it");
                             gantry.deactivateGripper("left_arm");
+                            gantry.goToPresetLocation(gantry.agv2_);
                         }
-                        logicam12 = comp.getter_logicam_callback();
-                        logicam[2] = logicam12[2];
-                        part_on_belt++;
-                        ROS_INFO_STREAM("\nPart on belt value has been incremented!!!!!!");
-                        gantry.goToPresetLocation(gantry.start1_);
-                        order_flag[i1][j1][k1] = 1;
-                    } while (part_on_belt < on_belt);
-                }
-
-                if (or_details[i][j][k].agv_id == "any" && j==0)
-                    or_details[i][j][k].agv_id = "agv1";
-                else if (or_details[i][j][k].agv_id == "any" && j!=0)
-                    or_details[i][j][k].agv_id = "agv2";
-
-                //loop for checking for picking other parts from their locations
-                for (int x = 0; x < 17; x++)
-                {
-                    if (count == 1)
+                        on_table_2++;
+                    }
+                    else if (order_book.product(i, j, k).agv_id=="agv1")
                     {
-                        ROS_INFO_STREAM("Count is 1");
-                        if (new_order)
+                        gantry.goToPresetLocation(gantry.agv1f_);
+                        ROS_INFO_STREAM("\n Reconfiguring for better pickup...");
+                        auto agv_faulty = gantry.agv1_;
+                        if (faulty_pose.pose.position.x < 0 && faulty_pose.pose.position.y > 7.12)
                         {
-                            j=0;
-                            k=-1;
+                            ROS_INFO_STREAM("Faulty pose at Left top of tray!!");
+                            agv_faulty = gantry.agv1flt_;
                         }
-                        break;
-                    }
-                    for (int y = 0; y < 36; y++)
-                    {
-                        if (logicam[x][y].type == comp.received_orders_[i].shipments[j].products[k].type && logicam[x][y].Shifted == false) {
-                            ROS_INFO_STREAM("\n\nPart being taken " << logicam[x][y].type);
-                            ROS_INFO_STREAM("\n\nlogical camera: " << x);
-                            gantry.goToPresetLocation(gantry.start_);
-
-//                            ROS_INFO_STREAM("\n Test run of move to preset location function.");
-                            location = logicam[x][y].frame;
-                            auto location1 = logicam[x][y].frame;
-                            ROS_INFO_STREAM("X POSITION " << logicam[x][y].pose.position.x);
-                            ROS_INFO_STREAM("Y POSITION " << logicam[x][y].pose.position.y);
-                            ROS_INFO_STREAM("Z POSITION " << logicam[x][y].pose.position.z);
-                            ROS_INFO_STREAM("Location: " << location);
-                            auto target_pose = gantry.getTargetWorldPose(or_details[i][j][k].pose, "agv1");
-                            loc_x = logicam[x][y].pose.position.x;
-                            loc_y = logicam[x][y].pose.position.y;
-                            gantry.moveToPresetLocation(presetLocation, location, loc_x, loc_y, 1, logicam[x][y].type,comp.gap_nos, comp);
-                            ROS_INFO_STREAM("update Location: " << location);
-                            part my_part;
-                            my_part.type = logicam[x][y].type;
-                            my_part.pose = logicam[x][y].pose;
-//                            if ((loc_x<3.9 && loc_x> 3.2) && (loc_y>-2.4 && loc_y<-1.85))           //BIN14 alone, some moveit problem..
-//                                my_part.pose.position.z -= 0.06;
-
-                            if ((loc_x<3.9 && loc_x> 3.2) && (loc_y>-2.4 && loc_y<-1.85))           //BIN14 alone, some moveit problem..
-                            my_part.pose.position.z -= 0.06;
-                            else if ((loc_x>4.1 && loc_x<4.8) && (loc_y>-2.4 && loc_y<-1.85))
-                                my_part.pose.position.z -= 0.02;
-
-                            ros::Duration(1).sleep();
-                            gantry.pickPart(my_part);
-                            ros::Duration(1).sleep();
-                            gantry.moveToPresetLocation(presetLocation, location1, loc_x, loc_y, 2, logicam[x][y].type,comp.gap_nos, comp);
-                            ROS_INFO_STREAM("GOING TO START JUST TO BE SAFE!!!!!!");
-                            gantry.goToPresetLocation(gantry.start_);
-                            ROS_INFO_STREAM("Approaching AGV's to place object!!!");
-                            if (or_details[i][j][k].agv_id == "agv1") {
-                                gantry.goToPresetLocation(gantry.agv1_);
-                                ROS_INFO_STREAM("\n Waypoint AGV1 reached\n");
-                                if (or_details[i][j][k].pose.orientation.x != 0) {
-                                    ROS_INFO_STREAM("Part is to be flipped");
-                                    gantry.goToPresetLocation(gantry.agv1c_);
-                                    ROS_INFO_STREAM("\n Waypoint AGV1 reached\n");
-                                    gantry.goToPresetLocation(gantry.agv1flipa_);
-                                    gantry.activateGripper("right_arm");
-                                    ros::Duration(0.2).sleep();
-                                    gantry.deactivateGripper("left_arm");
-                                    ROS_INFO_STREAM("Part flipped");
-                                    or_details[i][j][k].pose.orientation.x = 0.0;
-                                    or_details[i][j][k].pose.orientation.y = 0;
-                                    or_details[i][j][k].pose.orientation.z = 0.0;
-                                    or_details[i][j][k].pose.orientation.w = 1;
-                                    gantry.goToPresetLocation(gantry.agv1flipb_);
-                                    gantry.placePartRight(or_details[i][j][k], "agv1");
-                                    ROS_INFO_STREAM("\n Object placed!!!!!!!!!!\n");
-                                    gantry.goToPresetLocation(gantry.agv1_);
-                                } else
-                                    gantry.placePart(or_details[i][j][k], "agv1");
-                                logicam[x][y].Shifted = true;
-                            } else if (or_details[i][j][k].agv_id == "agv2") {
-                                gantry.goToPresetLocation(gantry.agv2_);
-                                ROS_INFO_STREAM("\n Waypoint AGV2 reached\n");
-                                if (or_details[i][j][k].pose.orientation.x != 0) {
-                                    ROS_INFO_STREAM("Part is to be flipped");
-                                    gantry.goToPresetLocation(gantry.agv2a_);
-                                    ROS_INFO_STREAM("\n Waypoint AGV2 reached\n");
-                                    gantry.activateGripper("right_arm");
-                                    ros::Duration(0.2).sleep();
-                                    gantry.deactivateGripper("left_arm");
-                                    ROS_INFO_STREAM("Part flipped");
-                                    or_details[i][j][k].pose.orientation.x = 0.0;
-                                    or_details[i][j][k].pose.orientation.y = 0;
-                                    or_details[i][j][k].pose.orientation.z = 0.0;
-                                    or_details[i][j][k].pose.orientation.w = 1;
-                                    gantry.goToPresetLocation(gantry.agv2b_);
-                                    gantry.placePartRight(or_details[i][j][k], "agv2");
-                                    ROS_INFO_STREAM("\n Object placed!!!!!!!!!!\n");
-                                    gantry.goToPresetLocation(gantry.agv2_);
-                                } else
-                                    gantry.placePart(or_details[i][j][k], "agv2");
-                                logicam[x][y].Shifted = true;
-                                target_pose = gantry.getTargetWorldPose(or_details[i][j][k].pose, "agv2");
-                            }
-
-                            //Checking to erase in next logicam matrix..
-                            for (int y1=0; y1<36; y1++)
-                            {
-                                if (x==Max_number_of_cameras-1)
-                                    break;
-                                else if((abs(logicam[x][y].pose.position.x - logicam[x+1][y1].pose.position.x) < 0.01) && (abs(logicam[x][y].pose.position.y - logicam[x+1][y1].pose.position.y) < 0.01)) {
-                                    ROS_INFO_STREAM("\n Common part for 2 cameras, marking as completed for next iteration!");
-                                    logicam[x + 1][y1].Shifted = true;
-                                }
-                            }
-
-                            logicam2 = comp.getter_logicam_callback();
-                            ROS_INFO_STREAM("\n After placing.");
-                            ROS_INFO_STREAM("\n order name: "<<comp.received_orders_[i].shipments[j].products[k].type);
-                            ROS_INFO_STREAM("\n order details: "<<or_details[i][j][k].pose);
-                            ROS_INFO_STREAM("\n Target pose: "<<target_pose);
-                            auto cam = logicam2[10][on_table_1].pose;
-                            if (or_details[i][j][k].agv_id=="agv1")
-                            {
-                                for (auto ill=0; ill<=on_table_1; ill++)
-                                {
-                                    if (logicam2[10][ill].type == comp.received_orders_[i].shipments[j].products[k].type && abs(logicam2[10][ill].pose.position.x-target_pose.position.x)<0.1 && abs(logicam2[10][ill].pose.position.y-target_pose.position.y)<0.1)
-                                    {
-                                        ROS_INFO_STREAM("\n Printing agv1 index value: "<<ill<<"\n Also product type = "<<logicam2[10][ill].type);
-                                        index=ill;
-                                        break;
-                                    }
-                                }
-                                ROS_INFO_STREAM("\n AGV camera details: "<<logicam2[10][index].pose);
-                                cam = logicam2[10][index].pose;
-                                ros::Duration(1).sleep();
-                                faulty_part = comp.quality_sensor_status1();
-                            }
-                            else if (or_details[i][j][k].agv_id=="agv2")
-                            {
-                                for (auto ill=0; ill<=on_table_2; ill++)
-                                {
-                                    if (logicam2[11][ill].type == comp.received_orders_[i].shipments[j].products[k].type && abs(logicam2[11][ill].pose.position.x-target_pose.position.x)<0.1 && abs(logicam2[11][ill].pose.position.y-target_pose.position.y)<0.1)
-                                    {
-                                        ROS_INFO_STREAM("\n Printing agv2 index value: "<<ill<<"\n Also product type = "<<logicam2[11][ill].type);
-                                        index=ill;
-                                        break;
-                                    }
-                                }
-                                ROS_INFO_STREAM("\n AGV camera details: "<<logicam2[11][index].pose);
-                                cam = logicam2[11][index].pose;
-                                ros::Duration(1).sleep();
-                                faulty_part = comp.quality_sensor_status();
-                            }
-                            ROS_INFO_STREAM("\n X offset: "<<abs(cam.position.x-target_pose.position.x));
-                            ROS_INFO_STREAM("\n Y offset: "<<abs(cam.position.y-target_pose.position.y));
-
-                            Model_adjust = abs(cam.position.z-target_pose.position.z);
-
-// Faulty part check
-                            if(faulty_part.faulty == true)
-                            {
-                                ROS_INFO_STREAM("Faulty Part detected!!!");
-                                faulty_part.type = my_part.type;
-                                ROS_INFO_STREAM("\n Trying to compute path for "<<faulty_part.type);
-                                ROS_INFO_STREAM("\n Pose at faulty part "<<cam);
-                                faulty_part.pose = cam;
-                                faulty_part.pose.position.z -= Model_adjust;
-                                ROS_INFO_STREAM("\n Pose for Faulty part "<<faulty_part.pose);
-                                if (or_details[i][j][k].agv_id=="agv2")
-                                {
-                                    gantry.goToPresetLocation(gantry.agv2f_);
-                                    auto agv_faulty = gantry.agv2_;
-                                    if (faulty_part.pose.position.x > 0 && faulty_part.pose.position.y < -7.26)
-                                    {
-                                        ROS_INFO_STREAM("Faulty part at Left top of tray!!");
-                                        agv_faulty = gantry.agv2flt_;
-                                    }
-                                    else if (faulty_part.pose.position.x > 0 && faulty_part.pose.position.y > -7.26)
-                                    {
-                                        ROS_INFO_STREAM("Faulty part at Left bottom of tray!!");
-                                        agv_faulty = gantry.agv2flb_;
-                                    }
-                                    else if (faulty_part.pose.position.x < 0 && faulty_part.pose.position.y < -7.26)
-                                    {
-                                        ROS_INFO_STREAM("Faulty part at Right top of tray!!");
-                                        agv_faulty = gantry.agv2frt_;
-                                    }
-                                    else if (faulty_part.pose.position.x < 0 && faulty_part.pose.position.y > -7.26)
-                                    {
-                                        ROS_INFO_STREAM("Faulty part at Right bottom of tray!!");
-                                        agv_faulty = gantry.agv2frb_;
-                                    }
-                                    gantry.goToPresetLocation(agv_faulty);
-                                    gantry.pickPart(faulty_part);
-                                    gantry.goToPresetLocation(agv_faulty);
-                                }
-                                else if (or_details[i][j][k].agv_id=="agv1")
-                                {
-                                    gantry.goToPresetLocation(gantry.agv1f_);
-                                    auto agv_faulty = gantry.agv1_;
-                                    if (faulty_part.pose.position.x < 0 && faulty_part.pose.position.y > 7.12)
-                                    {
-                                        ROS_INFO_STREAM("Faulty part at Left top of tray!!");
-                                        agv_faulty = gantry.agv1flt_;
-                                    }
-                                    else if (faulty_part.pose.position.x < 0 && faulty_part.pose.position.y < 7.12)
-                                    {
-                                        ROS_INFO_STREAM("Faulty part at Left bottom of tray!!");
-                                        agv_faulty = gantry.agv1flb_;
-                                    }
-                                    else if (faulty_part.pose.position.x > 0 && faulty_part.pose.position.y > 7.12)
-                                    {
-                                        ROS_INFO_STREAM("Faulty part at Right top of tray!!");
-                                        agv_faulty = gantry.agv1frt_;
-                                    }
-                                    else if (faulty_part.pose.position.x > 0 && faulty_part.pose.position.y < 7.12)
-                                    {
-                                        ROS_INFO_STREAM("Faulty part at Right bottom of tray!!");
-                                        agv_faulty = gantry.agv1frb_;
-                                    }
-                                    gantry.goToPresetLocation(agv_faulty);
-                                    gantry.pickPart(faulty_part);
-                                    gantry.goToPresetLocation(agv_faulty);
-                                }
-                                gantry.goToPresetLocation(gantry.start_);
-                                gantry.goToPresetLocation(gantry.agv_faulty);
-                                gantry.deactivateGripper("left_arm");
-                                continue;
-                            }
-
-//Faulty pose correction
-                            else if (abs(cam.position.x-target_pose.position.x)>0.03 || abs(cam.position.y-target_pose.position.y)>0.03)
-                            {
-                                if (abs(cam.position.x-target_pose.position.x)>0.03)
-                                    ROS_INFO_STREAM("\n X offset detected");
-                                if (abs(cam.position.y-target_pose.position.y)>0.03)
-                                    ROS_INFO_STREAM("\n Y offset detected");
-                                ROS_INFO_STREAM("\n Faulty Pose detected for part "<<logicam[x][y].type);
-                                faulty_pose.type = my_part.type;
-                                ROS_INFO_STREAM("\n Trying to compute path for "<<faulty_pose.type);
-                                ROS_INFO_STREAM("\n Faulty pose "<<cam);
-                                faulty_pose.pose = cam;
-                                faulty_pose.pose.position.z -= Model_adjust;
-                                if (or_details[i][j][k].agv_id=="agv2")
-                                {
-                                    gantry.goToPresetLocation(gantry.agv2f_);
-                                    ROS_INFO_STREAM("\n Reconfiguring for better pickup...");
-                                    auto agv_faulty = gantry.agv2_;
-                                    if (faulty_pose.pose.position.x > 0 && faulty_pose.pose.position.y < -7.26)
-                                    {
-                                        ROS_INFO_STREAM("Faulty pose at Left top of tray!!");
-                                        agv_faulty = gantry.agv2flt_;
-                                    }
-                                    else if (faulty_pose.pose.position.x > 0 && faulty_pose.pose.position.y > -7.26)
-                                    {
-                                        ROS_INFO_STREAM("Faulty pose at Left bottom of tray!!");
-                                        agv_faulty = gantry.agv2flb_;
-                                    }
-                                    else if (faulty_pose.pose.position.x < 0 && faulty_pose.pose.position.y < -7.26)
-                                    {
-                                        ROS_INFO_STREAM("Faulty pose at Right top of tray!!");
-                                        agv_faulty = gantry.agv2frt_;
-                                    }
-                                    else if (faulty_pose.pose.position.x < 0 && faulty_pose.pose.position.y > -7.26)
-                                    {
-                                        ROS_INFO_STREAM("Faulty pose at Right bottom of tray!!");
-                                        agv_faulty = gantry.agv2frb_;
-                                    }
-                                    gantry.goToPresetLocation(agv_faulty);
-                                    gantry.pickPart(faulty_pose);
-                                    ros::Duration(0.2).sleep();
-                                    ROS_INFO_STREAM("\nPart Picked!");
-                                    gantry.goToPresetLocation(gantry.agv2_);
-                                    gantry.placePart(or_details[i][j][k], "agv2");
-                                    ROS_INFO_STREAM("\n Placed!!!");
-                                    on_table_2++;
-                                }
-                                else if (or_details[i][j][k].agv_id=="agv1")
-                                {
-                                    gantry.goToPresetLocation(gantry.agv1f_);
-                                    ROS_INFO_STREAM("\n Reconfiguring for better pickup...");
-                                    auto agv_faulty = gantry.agv1_;
-                                    if (faulty_pose.pose.position.x < 0 && faulty_pose.pose.position.y > 7.12)
-                                    {
-                                        ROS_INFO_STREAM("Faulty pose at Left top of tray!!");
-                                        agv_faulty = gantry.agv1flt_;
-                                    }
-                                    else if (faulty_pose.pose.position.x < 0 && faulty_pose.pose.position.y < 7.12)
-                                    {
-                                        ROS_INFO_STREAM("Faulty pose at Left bottom of tray!!");
-                                        agv_faulty = gantry.agv1flb_;
-                                    }
-                                    else if (faulty_pose.pose.position.x > 0 && faulty_pose.pose.position.y > 7.12)
-                                    {
-                                        ROS_INFO_STREAM("Faulty pose at Right top of tray!!");
-                                        agv_faulty = gantry.agv1frt_;
-                                    }
-                                    else if (faulty_pose.pose.position.x > 0 && faulty_pose.pose.position.y < 7.12)
-                                    {
-                                        ROS_INFO_STREAM("Faulty pose at Right bottom of tray!!");
-                                        agv_faulty = gantry.agv1frb_;
-                                    }
-                                    gantry.goToPresetLocation(agv_faulty);
-                                    gantry.pickPart(faulty_pose);
-                                    ros::Duration(0.2).sleep();
-                                    ROS_INFO_STREAM("\nPart Picked!");
-                                    gantry.goToPresetLocation(gantry.agv1_);
-                                    gantry.placePart(or_details[i][j][k], "agv1");
-                                    ROS_INFO_STREAM("\n Placed!!!");
-                                    on_table_1++;
-                                }
-                            }
-                            else
-                            {
-                                if (or_details[i][j][k].agv_id=="agv2")
-                                    on_table_2++;
-                                else if (or_details[i][j][k].agv_id=="agv1")
-                                    on_table_1++;
-                                ROS_INFO_STREAM("Part has been placed without any problem, moving onto next product!");
-                            }
-                            auto state = gantry.getGripperState("left_arm");
-                            if (state.attached)
-                                gantry.goToPresetLocation(gantry.start_);
-                            count++;
-                            order_flag[i][j][k]=1;
-
-                            //Checking if this is the last product of the shipment, and submitting score
-                            if (k==comp.received_orders_[i].shipments[j].products.size()-1)
-                            {
-                                completed2[i]=1;
-                                if (or_details[i][j][k].agv_id=="agv1")
-                                {
-                                    ROS_INFO_STREAM("\n Submitting Order: "<<or_details_new[i][j][k].shipment);
-                                    submitOrder(1, or_details_new[i][j][k].shipment);
-                                }
-                                else if (or_details[i][j][k].agv_id=="agv2")
-                                {
-                                    ROS_INFO_STREAM("\n Submitting Order: "<<or_details_new[i][j][k].shipment);
-                                    submitOrder(2, or_details_new[i][j][k].shipment);
-                                }
-                            }
-                            or_details_new = comp.getter_part_callback();
+                        else if (faulty_pose.pose.position.x < 0 && faulty_pose.pose.position.y < 7.12)
+                        {
+                            ROS_INFO_STREAM("Faulty pose at Left bottom of tray!!");
+                            agv_faulty = gantry.agv1flb_;
+                        }
+                        else if (faulty_pose.pose.position.x > 0 && faulty_pose.pose.position.y > 7.12)
+                        {
+                            ROS_INFO_STREAM("Faulty pose at Right top of tray!!");
+                            agv_faulty = gantry.agv1frt_;
+                        }
+                        else if (faulty_pose.pose.position.x > 0 && faulty_pose.pose.position.y < 7.12)
+                        {
+                            ROS_INFO_STREAM("Faulty pose at Right bottom of tray!!");
+                            agv_faulty = gantry.agv1frb_;
+                        }
+                        gantry.goToPresetLocation(agv_faulty);
+                        if (gantry.pickPart(faulty_pose))
+                        {
                             ros::Duration(0.2).sleep();
-                            ROS_INFO_STREAM("\n Checking for high priority order insertion.. absent? (1 is true) "<<or_details_new[i+1][j][k].shipment.empty());
-                            if (!or_details_new[i+1][j][k].shipment.empty())
-                            {
-                                ROS_INFO_STREAM("\n Order NEW shipment name 1: "<<or_details_new[i+1][j][k].shipment);
-                                or_details[i+1]=or_details_new[i+1];
-                                ROS_INFO_STREAM("\n Copied info details "<<or_details[i+1][j][k].shipment);
-                                i=i+1;
-                                ROS_INFO_STREAM("\n Value of i: "<<i);
-                                ROS_INFO_STREAM("\n New order size detected.. breaking.. ");
-                                new_order++;
-                                ROS_INFO_STREAM("\n Value of new: "<<new_order);
-                            }
-                            if (completed2[i]==1)
-                                i=0;
-                            break;
+                            ROS_INFO_STREAM("\nPart Picked!");
+                            gantry.goToPresetLocation(gantry.agv1_);
+                            gantry.placePart(order_book.product(i, j, k), "agv1",
+                                             corrector.correction("left_arm", "agv1", my_part.type));
+                            ROS_INFO_STREAM("\n Placed!!!");
+                        }
+                        else
+                        {
+                            ROS_WARN_STREAM("\n Could not pick the misplaced " << my_part.type << " up again, leaving it");
+                            gantry.deactivateGripper("left_arm");
+                            gantry.goToPresetLocation(gantry.agv1_);
                         }
+                        on_table_1++;
                     }
                 }
+                else
+                {
+                    if (order_book.product(i, j, k).agv_id=="agv2")
+                        on_table_2++;
+                    else if (order_book.product(i, j, k).agv_id=="agv1")
+                        on_table_1++;
+                    ROS_INFO_STREAM("Part has been placed without any problem, moving onto next product!");
+                }
+                auto state = gantry.getGripperState("left_arm");
+                if (state.attached)
+                    gantry.goToPresetLocation(gantry.start_);
+                count++;
+                if (from_belt)
+                {
+                    double direct = (ros::Time::now() - belt_grasped).toSec();
+                    direct_placements++;
+                    direct_savings += staged_estimate - direct_estimate;
+                    ROS_INFO_STREAM("\n Belt part placed directly in " << direct << " s, estimated " << direct_estimate
+                                    << " s direct against " << staged_estimate << " s staged");
+                }
+
+                //Submitting the shipment once its last product is placed and every verdict on its tray is good
+                if (scheduler.complete(current.product_id))
+                {
+                    if (remediate(agv, true) == 0)
+                        submitShipment(dispatcher, order_book.product(i, j, k));
+                }
+                else
+                    remediate(agv, false);
+                state = gantry.getGripperState("left_arm");
+
+                //Safe point: orders announced meanwhile are queued and preempt if more urgent
+                announced.clear();
+                for (auto &shipment : order_book.changesSince(order_feed))
+                {
+                    ROS_INFO_STREAM("\n New order " << shipment.order << ", shipment " << order_book.product(shipment.first_product).shipment);
+                    scheduler.addShipment(shipment.order, shipment.shipment, shipment.first_product, shipment.product_count, shipment.order);
+                    announced.insert(shipment.order);
+                }
+                //products of the new orders that no bin holds are waited for on the belt
+                comp.PartonBeltCheck(order_book, belt_checked_orders, 0, logicam, belt_part_arr, on_belt);
+                for (auto priority : announced)
+                    sequenceTasks(scheduler, priority, order_book, logicam, gantry.getGantryPosition(),
+                      aisle_monitor.blocked(ros::Time::now().toSec()), sequencer);
+                if (!state.attached && chained_to < 0)
+                    waiting_at = preposition();
+                break;
             }
         }
-        gantry.goToPresetLocation(gantry.start_);
-        comp.endCompetition();
-        spinner.stop();
-        ros::shutdown();
-        return 0;
+        if (count == 0)
+        {
+            ROS_WARN_STREAM("\n No " << order_book.product(i, j, k).type << " found, deferring");
+            //a dropped product counts as done, its shipment goes out with what is on the tray
+            if (scheduler.defer(current) && remediate(order_book.product(i, j, k).agv_id, true) == 0)
+                submitShipment(dispatcher, order_book.product(i, j, k));
+        }
     }
+    ROS_INFO_STREAM("[main] all tasks done, " << scheduler.preemptions() << " preemptions, "
+                    << scheduler.dropped() << " products dropped, competition time " << comp.getClock() << " s");
+    ROS_INFO_STREAM("[main] belt: " << interceptor.grasps() << " parts intercepted, " << interceptor.misses()
+                    << " missed, " << interceptor.slack() << " s spent waiting at the belt");
+    ROS_INFO_STREAM("[main] belt: " << direct_placements << " parts placed directly on a tray, "
+                    << staging.staged() << " staged, " << direct_savings << " s estimated saved by direct placement");
+    ROS_INFO_STREAM("[main] pre-positioning: " << predictor.hits() << " hits, " << predictor.misses() << " misses");
+    ROS_INFO_STREAM("[main] placements: " << corrector.placements() << ", " << corrector.regrasps()
+                    << " regrasped for pose correction");
+    ROS_INFO_STREAM("[main] faulty parts: " << disposal.disposals() << " dropped, " << disposal.savings()
+                    << " s saved by the drop point choice");
+    ROS_INFO_STREAM("[main] " << selector.selections() << " part selections in " << selector.rankingTime() << " s");
+    gantry.goToPresetLocation(gantry.start_);
+    gantry.printRetimeReport();
+    if (calibration.updates() > 0 && !calibration.save())
+        ROS_WARN_STREAM("[main] could not save the calibration to " << calibration_path);
+    dispatcher.waitAll();
+    dispatcher.printReport();
+    comp.endCompetition();
+    spinner.stop();
+    ros::shutdown();
+    return 0;
 }
\ No newline at end of file
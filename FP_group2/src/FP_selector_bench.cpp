@@ -0,0 +1,40 @@
+/**
+ * @file FP_selector_bench.cpp
+ * @brief Selection rate of PartSelector::rank for inventories far larger
+ * than a trial spawns, to check ranking stays negligible next to a pick.
+ *
+ * usage: FP_selector_bench [selections=1000] [seed=1]
+ */
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "part_selector.h"
+
+int main(int argc, char **argv)
+{
+    int selections = argc > 1 ? std::atoi(argv[1]) : 1000;
+    unsigned seed = argc > 2 ? std::atoi(argv[2]) : 1;
+    std::mt19937 random(seed);
+    std::uniform_real_distribution<double> x(-15.0, 5.0), y(-5.0, 5.0);
+    const std::array<int, 4> human = {0, 1, 0, 1};
+
+    std::printf("inventory   selections/s   us per candidate\n");
+    for (int size : {10, 100, 1000, 10000, 100000}) {
+        std::vector<Candidate> inventory;
+        for (int slot = 0; slot < size; slot++)
+            inventory.push_back({slot % 17, slot, {x(random), y(random)}, 0.0});
+        PartSelector selector;
+        int runs = std::max(1, selections * 100 / size);
+        for (int run = 0; run < runs; run++) {
+            auto candidates = inventory;
+            point2 gantry = {x(random), y(random)};
+            selector.rank(candidates, gantry, run % 2 ? AGV1_POSITION : AGV2_POSITION, human);
+        }
+        double per_selection = selector.rankingTime() / selector.selections();
+        std::printf("%9d   %12.0f   %16.3f\n", size, 1.0 / per_selection, 1e6 * per_selection / size);
+    }
+    return 0;
+}
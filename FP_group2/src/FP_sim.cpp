@@ -0,0 +1,65 @@
+/**
+ * @file FP_sim.cpp
+ * @brief Runs a trial YAML through TrialSimulator several times and prints
+ * the averaged metrics, to compare executive changes without Gazebo.
+ *
+ * usage: FP_sim <trial.yaml> [runs=10] [seed=1] [--compare-loop]
+ *
+ * --compare-loop runs the trial a second time with the nested order loop the
+ * task scheduler replaced, e.g. for each of config/hpo_*.yaml.
+ */
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "trial_simulator.h"
+
+namespace {
+
+/// Average metrics of @p runs runs from @p seed on, -1 runs if the trial cannot be loaded
+std::vector<SimMetrics> simulate(const char *path, int runs, unsigned seed, bool old_loop)
+{
+    std::vector<SimMetrics> metrics;
+    for (int run = 0; run < runs; run++) {
+        TrialSimulator simulator(seed + run, old_loop);
+        if (!simulator.load(path))
+            return {};
+        metrics.push_back(simulator.run());
+    }
+    return metrics;
+}
+
+}
+
+int main(int argc, char **argv)
+{
+    std::vector<std::string> args(argv + 1, argv + argc);
+    bool compare_loop = false;
+    for (auto arg = args.begin(); arg != args.end(); )
+        if (*arg == "--compare-loop") {
+            compare_loop = true;
+            arg = args.erase(arg);
+        } else {
+            ++arg;
+        }
+    if (args.empty()) {
+        std::cerr << "usage: " << argv[0] << " <trial.yaml> [runs=10] [seed=1] [--compare-loop]" << std::endl;
+        return 1;
+    }
+    int runs = args.size() > 1 ? std::atoi(args[1].c_str()) : 10;
+    unsigned seed = args.size() > 2 ? std::atoi(args[2].c_str()) : 1;
+
+    auto metrics = simulate(args[0].c_str(), runs, seed, false);
+    if (metrics.empty())
+        return 1;
+    if (compare_loop)
+        std::printf("-- task scheduler\n");
+    TrialSimulator::printReport(metrics);
+    if (compare_loop) {
+        std::printf("-- nested order loop\n");
+        TrialSimulator::printReport(simulate(args[0].c_str(), runs, seed, true));
+    }
+    return 0;
+}
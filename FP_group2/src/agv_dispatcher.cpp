@@ -0,0 +1,148 @@
+#include "agv_dispatcher.h"
+
+#include <nist_gear/AGVControl.h>
+
+AgvDispatcher::AgvDispatcher(ros::NodeHandle &node):
+        node_(node), in_flight_({false, false}), busy_(false), stopping_(false), submitted_(0), failed_(0),
+        latency_(0.0)
+{
+}
+
+AgvDispatcher::~AgvDispatcher()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    if (worker_.joinable())
+        worker_.join();
+}
+
+/**
+ * @brief Connect to both AGV services and state topics and start the worker.
+ * Called once at startup, so a missing service is noticed here rather than
+ * when the first shipment is ready.
+ */
+void AgvDispatcher::init()
+{
+    for (int agv = 0; agv < NUMBER_OF_AGVS; agv++) {
+        std::string service = "/ariac/agv" + std::to_string(agv + 1);
+        clients_[agv] = node_.serviceClient<nist_gear::AGVControl>(service, true);
+        if (!clients_[agv].waitForExistence(ros::Duration(AGV_SERVICE_TIMEOUT)))
+            ROS_WARN_STREAM("[AgvDispatcher::init] " << service << " not available yet");
+
+        state_subscribers_[agv] = node_.subscribe<std_msgs::String>(
+                service + "/state", 10, boost::bind(&AgvDispatcher::agv_state_callback, this, _1, agv + 1));
+    }
+    worker_ = std::thread(&AgvDispatcher::worker, this);
+}
+
+/**
+ * @brief Queue a shipment for delivery and return at once.
+ * @return becomes true when the AGV accepted the shipment
+ */
+std::shared_future<bool> AgvDispatcher::submit(int agv_id, const std::string &shipment_type)
+{
+    auto done = std::make_shared<std::promise<bool>>();
+    std::shared_future<bool> result = done->get_future().share();
+    if (agv_id < 1 || agv_id > NUMBER_OF_AGVS) {
+        ROS_ERROR_STREAM("[AgvDispatcher::submit] No AGV with id " << agv_id << ". Valid ids are 1 and 2 only");
+        done->set_value(false);
+        return result;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queue_.push_back({agv_id, shipment_type, done, ros::WallTime::now()});
+        in_flight_[agv_id - 1] = true;
+    }
+    wake_.notify_one();
+    ROS_INFO_STREAM("[AgvDispatcher::submit] AGV " << agv_id << " queued for " << shipment_type);
+    return result;
+}
+
+/// True if the AGV is at its station and nothing is queued for it
+bool AgvDispatcher::available(int agv_id) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    int agv = agv_id - 1;
+    return !in_flight_[agv] && (states_[agv].empty() || states_[agv] == "ready_to_deliver");
+}
+
+std::string AgvDispatcher::state(int agv_id) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return states_[agv_id - 1];
+}
+
+/// Block until every queued submission got its response
+void AgvDispatcher::waitAll()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    idle_.wait(lock, [this]() { return queue_.empty() && !busy_; });
+}
+
+void AgvDispatcher::printReport() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    ROS_INFO_STREAM("[AgvDispatcher] " << submitted_ << " shipments submitted, " << failed_ << " failed, mean latency "
+                    << (submitted_ ? latency_ / submitted_ : 0.0) << " s");
+}
+
+void AgvDispatcher::agv_state_callback(const std_msgs::String::ConstPtr &msg, int agv_id)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    int agv = agv_id - 1;
+    if (msg->data != states_[agv])
+        ROS_INFO_STREAM("[AgvDispatcher] AGV " << agv_id << " " << msg->data);
+    // back at the station after a delivery was requested and made
+    if (in_flight_[agv] && msg->data == "ready_to_deliver" && states_[agv] != "ready_to_deliver" && !states_[agv].empty())
+        in_flight_[agv] = false;
+    states_[agv] = msg->data;
+}
+
+/// Reconnect a persistent client whose connection dropped
+ros::ServiceClient & AgvDispatcher::client(int agv_id)
+{
+    auto &client = clients_[agv_id - 1];
+    if (!client.isValid())
+        client = node_.serviceClient<nist_gear::AGVControl>("/ariac/agv" + std::to_string(agv_id), true);
+    return client;
+}
+
+void AgvDispatcher::worker()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        wake_.wait(lock, [this]() { return stopping_ || !queue_.empty(); });
+        if (queue_.empty())
+            return;
+        Submission next = queue_.front();
+        queue_.pop_front();
+        busy_ = true;
+        lock.unlock();
+
+        nist_gear::AGVControl srv;
+        srv.request.shipment_type = next.shipment_type;
+        bool called = client(next.agv_id).call(srv);
+        if (!called)
+            ROS_ERROR_STREAM("[AgvDispatcher::worker] AGV " << next.agv_id << " service call failed");
+        else if (!srv.response.success)
+            ROS_ERROR_STREAM("[AgvDispatcher::worker] Failed to submit: " << srv.response.message);
+        else
+            ROS_INFO_STREAM("[AgvDispatcher::worker] AGV " << next.agv_id << " submitted " << next.shipment_type);
+        bool success = called && srv.response.success;
+
+        lock.lock();
+        submitted_++;
+        if (!success)
+            failed_++;
+        if (!success || states_[next.agv_id - 1].empty()) // no state topic to tell when it is back
+            in_flight_[next.agv_id - 1] = false;
+        latency_ += (ros::WallTime::now() - next.queued).toSec();
+        busy_ = false;
+        next.done->set_value(success);
+        idle_.notify_all();
+    }
+}
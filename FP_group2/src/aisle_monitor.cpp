@@ -0,0 +1,140 @@
+#include "aisle_monitor.h"
+
+#include <chrono>
+#include <limits>
+
+#include <ros/ros.h>
+
+AisleMonitor::AisleMonitor(BreakbeamMonitor &breakbeams, AislePredictor &predictor):
+        breakbeams_(breakbeams), predictor_(predictor), edged_(false), residents_(), running_(false)
+{
+    for (auto &state : states_)
+        state = {AISLE_CLEAR, 0.0};
+}
+
+AisleMonitor::~AisleMonitor()
+{
+    stop();
+}
+
+/**
+ * @brief Feed the predictor with the beam edges and start the thread.
+ * Call once, the edge callback cannot be removed.
+ * @param residents aisles someone was seen in at startup; they stay blocked
+ * until the predictor knows when that person walks
+ */
+void AisleMonitor::start(const std::array<int, NUMBER_OF_AISLES> &residents)
+{
+    if (running_.exchange(true))
+        return;
+    residents_ = residents;
+    breakbeams_.onEdge([this](int beam, bool rising, ros::Time stamp) {
+        predictor_.observe(beam, rising, stamp.toSec());
+        if (AislePredictor::aisleOfBeam(beam) < 0)
+            return;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            edged_ = true;
+        }
+        edge_.notify_one();
+    });
+    refresh(ros::Time::now().toSec());
+    thread_ = std::thread(&AisleMonitor::run, this);
+}
+
+void AisleMonitor::stop()
+{
+    if (!running_.exchange(false))
+        return;
+    edge_.notify_one();
+    if (thread_.joinable())
+        thread_.join();
+}
+
+/// @p callback runs on the monitor thread for every change of an aisle's occupancy
+void AisleMonitor::onChange(const ChangeCallback &callback)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    callbacks_.push_back(callback);
+}
+
+AisleState AisleMonitor::state(int aisle) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return aisle >= 0 && aisle < NUMBER_OF_AISLES ? states_[aisle] : AisleState{AISLE_CLEAR, 0.0};
+}
+
+/**
+ * @brief Aisles to route around at @p now: someone walks there and the aisle
+ * will not be clear within AISLE_MAX_WAIT. Same layout as Competition::humans().
+ */
+std::array<int, NUMBER_OF_AISLES> AisleMonitor::blocked(double now) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::array<int, NUMBER_OF_AISLES> aisles = {};
+    for (int aisle = 0; aisle < NUMBER_OF_AISLES; aisle++)
+        aisles[aisle] = states_[aisle].occupancy == AISLE_OCCUPIED && states_[aisle].clear_at - now > AISLE_MAX_WAIT;
+    return aisles;
+}
+
+void AisleMonitor::run()
+{
+    while (running_ && ros::ok())
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            edge_.wait_for(lock, std::chrono::duration<double>(AISLE_MONITOR_PERIOD),
+                           [this]() { return edged_ || !running_; });
+            edged_ = false;
+        }
+        refresh(ros::Time::now().toSec());
+    }
+}
+
+/// Recompute every aisle and report the ones that changed
+void AisleMonitor::refresh(double now)
+{
+    BeamSnapshot beams = breakbeams_.snapshot();
+    std::array<AisleState, NUMBER_OF_AISLES> states;
+    for (int aisle = 0; aisle < NUMBER_OF_AISLES; aisle++)
+    {
+        bool in_beam = false;
+        for (int beam = 0; beam < NUMBER_OF_BREAKBEAMS; beam++)
+            in_beam |= AislePredictor::aisleOfBeam(beam) == aisle && beams.detected(beam);
+        bool occupied = in_beam || predictor_.occupied(aisle, now);
+        ClearWindow window = predictor_.nextClear(aisle, now, AISLE_PICK_TIME);
+        double clear_at = window.feasible ? window.start : std::numeric_limits<double>::infinity();
+        if (in_beam && clear_at <= now)
+            clear_at = now + AISLE_SWEEP_GAP;  // seen right now, whatever the model says
+        if (residents_[aisle] && !predictor_.predictable(aisle))
+        {
+            occupied = true;
+            clear_at = std::numeric_limits<double>::infinity();
+        }
+        states[aisle] = {occupied ? AISLE_OCCUPIED : AISLE_CLEAR, occupied ? clear_at : now};
+    }
+
+    std::vector<int> changed;
+    std::vector<ChangeCallback> callbacks;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (int aisle = 0; aisle < NUMBER_OF_AISLES; aisle++)
+        {
+            if (states[aisle].occupancy != states_[aisle].occupancy)
+                changed.push_back(aisle);
+            states_[aisle] = states[aisle];
+        }
+        callbacks = callbacks_;
+    }
+    if (changed.empty())
+        return;
+    for (auto aisle : changed)
+    {
+        if (states[aisle].occupancy == AISLE_OCCUPIED)
+            ROS_INFO_STREAM("[AisleMonitor] aisle " << aisle + 1 << " occupied, clear in " << states[aisle].clear_at - now << " s");
+        else
+            ROS_INFO_STREAM("[AisleMonitor] aisle " << aisle + 1 << " clear");
+        for (auto &callback : callbacks)
+            callback(aisle, states[aisle]);
+    }
+}
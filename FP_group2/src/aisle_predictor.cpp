@@ -0,0 +1,157 @@
+#include "aisle_predictor.h"
+
+#include <cmath>
+#include <limits>
+
+#include "part_selector.h"
+
+AislePredictor::AislePredictor()
+{
+}
+
+/// Period of the person in @p aisle, as the trial's aisle_layout gives it
+void AislePredictor::configure(int aisle, double start_time, double move_time, double wait_time)
+{
+    if (aisle < 0 || aisle >= NUMBER_OF_AISLES)
+        return;
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto &person = people_[aisle];
+    person.configured = true;
+    person.start_time = start_time;
+    person.move_time = move_time;
+    person.wait_time = wait_time;
+}
+
+/// Beam edge, from BreakbeamMonitor::onEdge. Edges close in time make one walk.
+void AislePredictor::observe(int beam, bool rising, double time)
+{
+    int aisle = aisleOfBeam(beam);
+    if (aisle < 0)
+        return;
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto &sweeps = people_[aisle].sweeps;
+    if (!sweeps.empty() && time - sweeps.back().second <= AISLE_SWEEP_GAP)
+        sweeps.back().second = std::max(sweeps.back().second, time);
+    else if (rising)
+        sweeps.push_back({time, time});
+}
+
+/// Someone was configured or seen in @p aisle
+bool AislePredictor::known(int aisle) const
+{
+    if (aisle < 0 || aisle >= NUMBER_OF_AISLES)
+        return false;
+    std::lock_guard<std::mutex> lock(mutex_);
+    return people_[aisle].configured || !people_[aisle].sweeps.empty();
+}
+
+/// The period of the person in @p aisle is configured or was measured
+bool AislePredictor::predictable(int aisle) const
+{
+    if (aisle < 0 || aisle >= NUMBER_OF_AISLES)
+        return false;
+    std::lock_guard<std::mutex> lock(mutex_);
+    double anchor, half_period, move;
+    return estimate(people_[aisle], anchor, half_period, move);
+}
+
+/**
+ * @brief Walks start at anchor + n * half_period and last move.
+ * @return false if the period is not known yet
+ */
+bool AislePredictor::estimate(const PersonModel &person, double &anchor, double &half_period, double &move) const
+{
+    if (person.configured) {
+        half_period = person.move_time + person.wait_time;
+        move = person.move_time;
+        anchor = person.sweeps.empty() ? person.start_time : person.sweeps.back().first;
+        return half_period > 0.0;
+    }
+    if (person.sweeps.size() < 2)
+        return false;
+    half_period = (person.sweeps.back().first - person.sweeps.front().first) / (person.sweeps.size() - 1);
+    move = 0.0;
+    for (auto &sweep : person.sweeps)
+        move = std::max(move, sweep.second - sweep.first);
+    anchor = person.sweeps.back().first;
+    return half_period > move;
+}
+
+bool AislePredictor::occupied(int aisle, double time) const
+{
+    if (aisle < 0 || aisle >= NUMBER_OF_AISLES)
+        return false;
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto &person = people_[aisle];
+    double anchor, half_period, move;
+    if (!estimate(person, anchor, half_period, move))
+        return !person.sweeps.empty() && time - person.sweeps.back().second < AISLE_SWEEP_GAP;
+    if (person.sweeps.empty() && time < person.start_time - AISLE_CLEAR_MARGIN)
+        return false;
+    double phase = std::fmod(time - anchor, half_period);
+    if (phase < 0.0)
+        phase += half_period;
+    return phase < move + AISLE_CLEAR_MARGIN || phase > half_period - AISLE_CLEAR_MARGIN;
+}
+
+/**
+ * @brief First interval of at least @p duration s, from @p time on, in which
+ * nobody walks in @p aisle.
+ * @return not feasible if the person never leaves the aisle that long
+ */
+ClearWindow AislePredictor::nextClear(int aisle, double time, double duration) const
+{
+    const double forever = std::numeric_limits<double>::infinity();
+    if (aisle < 0 || aisle >= NUMBER_OF_AISLES)
+        return {true, time, forever};
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto &person = people_[aisle];
+    if (!person.configured && person.sweeps.empty())
+        return {true, time, forever};
+
+    double anchor, half_period, move;
+    if (!estimate(person, anchor, half_period, move)) {
+        // one walk seen, period unknown: only wait for it to end
+        double start = std::max(time, person.sweeps.back().second + AISLE_SWEEP_GAP);
+        return {true, start, start + duration};
+    }
+    if (half_period - move - 2 * AISLE_CLEAR_MARGIN < duration)
+        return {false, time, time};
+
+    long first = std::floor((time - anchor) / half_period) - 1;
+    if (person.sweeps.empty() && time < person.start_time) {
+        if (person.start_time - AISLE_CLEAR_MARGIN - time >= duration)
+            return {true, time, person.start_time - AISLE_CLEAR_MARGIN};
+        first = 0;
+    }
+    for (long n = first; ; n++) {
+        double start = std::max(time, anchor + n * half_period + move + AISLE_CLEAR_MARGIN);
+        double end = anchor + (n + 1) * half_period - AISLE_CLEAR_MARGIN;
+        if (end - start >= duration)
+            return {true, start, end};
+    }
+}
+
+/**
+ * @brief Aisle watched by a breakbeam, -1 for the belt beam. Beams 1..20 sit
+ * along the shelf rows facing an aisle, 21..28 at both ends of the aisles.
+ */
+int AislePredictor::aisleOfBeam(int beam)
+{
+    if (beam >= 1 && beam <= 20)
+        return (beam - 1) / 5;
+    if (beam >= 21 && beam <= 24)
+        return beam - 21;
+    if (beam >= 25 && beam <= 28)
+        return beam - 25;
+    return -1;
+}
+
+/// Aisle whose world y is @p y, the location of a person in aisle_layout
+int AislePredictor::aisleAt(double y)
+{
+    for (int aisle = 0; aisle < NUMBER_OF_AISLES; aisle++)
+        if (std::fabs(AISLE_Y[aisle] - y) < 0.5)
+            return aisle;
+    return -1;
+}
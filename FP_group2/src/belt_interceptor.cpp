@@ -0,0 +1,59 @@
+#include "belt_interceptor.h"
+
+#include <algorithm>
+
+BeltInterceptor::BeltInterceptor(double speed):
+        speed_(speed), last_grasp_time_(0.0), grasps_(0), misses_(0), slack_(0.0)
+{
+}
+
+/// World y of the part at @p time, assuming it kept moving with the belt
+double BeltInterceptor::positionAt(const BeltSighting &sighting, double time) const
+{
+    return sighting.y + BELT_DIRECTION_Y * speed_ * (time - sighting.time);
+}
+
+/**
+ * @brief Where and when to grasp the part. The preset y of @p station is
+ * kept when the gantry, leaving @p gantry now, gets there first; otherwise the
+ * first grasp point it can reach further downstream, up to BELT_LAST_GRASP_Y.
+ * @param station world position of the belt preset for the part type
+ */
+Intercept BeltInterceptor::plan(const BeltSighting &sighting, point2 station, double now, point2 gantry) const
+{
+    double y = station.y + BELT_GRASP_OFFSET_Y;
+    Intercept result = meet(sighting, y, now, PartSelector::legTime(gantry, station) + BELT_STATION_SETTLE_TIME);
+    for (y = std::min(y, positionAt(sighting, now)) + BELT_DIRECTION_Y * BELT_INTERCEPT_STEP;
+         !result.feasible && y >= BELT_LAST_GRASP_Y; y += BELT_DIRECTION_Y * BELT_INTERCEPT_STEP)
+        result = meet(sighting, y, now, PartSelector::legTime(gantry, {station.x, y - BELT_GRASP_OFFSET_Y})
+                                        + BELT_STATION_SETTLE_TIME);
+    return result;
+}
+
+/// Time the part reaches grasp point @p y, and whether the gantry, leaving now, gets there first
+Intercept BeltInterceptor::meet(const BeltSighting &sighting, double y, double now, double travel_time) const
+{
+    Intercept result;
+    result.y = y;
+    result.arrival_time = sighting.time + (y - sighting.y) * BELT_DIRECTION_Y / speed_;
+    result.grasp_time = result.arrival_time - BELT_GRASP_LEAD;
+    result.slack = result.grasp_time - (now + travel_time);
+    result.feasible = result.slack >= BELT_INTERCEPT_MARGIN;
+    return result;
+}
+
+/**
+ * @brief Remember the outcome. The sighting is used up either way: a part the
+ * gantry went for must not be chased again, and one it could not reach is
+ * gone by the time a later sighting of it would be acted on.
+ */
+void BeltInterceptor::record(const BeltSighting &sighting, const Intercept &intercept, bool grasped)
+{
+    last_grasp_time_ = std::max(last_grasp_time_, intercept.feasible ? intercept.arrival_time : sighting.time);
+    if (grasped) {
+        grasps_++;
+        slack_ += intercept.slack;
+    } else {
+        misses_++;
+    }
+}
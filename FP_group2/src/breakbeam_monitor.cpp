@@ -0,0 +1,92 @@
+#include "breakbeam_monitor.h"
+
+#include <chrono>
+
+BreakbeamMonitor::BreakbeamMonitor()
+{
+}
+
+/**
+ * @brief New reading of @p beam. Only changes of state are edges; the
+ * sensors publish on every change, so repeated readings only update the
+ * sequence number.
+ */
+void BreakbeamMonitor::update(int beam, bool detected, uint32_t sequence, ros::Time stamp)
+{
+    if (store_.update(beam, detected, sequence, stamp.toNSec()) == 0)
+        return;
+    std::vector<EdgeCallback> callbacks;
+    {
+        // taken after the store changed, so a waiter is either before its check or already asleep
+        std::lock_guard<std::mutex> lock(mutex_);
+        callbacks = callbacks_;
+    }
+    changed_.notify_all();
+    for (auto &callback : callbacks)
+        callback(beam, detected, stamp);
+}
+
+/// @p callback runs for every edge of every beam, outside the monitor lock
+void BreakbeamMonitor::onEdge(const EdgeCallback &callback)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    callbacks_.push_back(callback);
+}
+
+/**
+ * @brief Block until the next @p edge of @p beam, one that happens after the call.
+ * @param timeout s
+ * @return false on timeout
+ */
+bool BreakbeamMonitor::waitForEdge(int beam, BeamEdge edge, double timeout)
+{
+    return waitForAny({beam}, edge, timeout) == beam;
+}
+
+/**
+ * @brief Block until one of @p beams has a new @p edge.
+ * @param timeout s
+ * @return the beam, -1 on timeout
+ */
+int BreakbeamMonitor::waitForAny(const std::vector<int> &beams, BeamEdge edge, double timeout)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    std::vector<uint32_t> seen;
+    for (auto beam : beams)
+        seen.push_back(store_.edges(beam, edge));
+
+    int fired = -1;
+    auto edged = [&]() {
+        for (int i = 0; i < int(beams.size()); i++)
+            if (store_.edges(beams[i], edge) != seen[i]) {
+                fired = beams[i];
+                return true;
+            }
+        return false;
+    };
+    changed_.wait_for(lock, std::chrono::duration<double>(timeout), edged);
+    return fired;
+}
+
+/**
+ * @brief Block while something is in @p beam, returns at once if it is clear.
+ * @return false if it is still blocked after @p timeout s
+ */
+bool BreakbeamMonitor::waitWhileDetected(int beam, double timeout)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    return changed_.wait_for(lock, std::chrono::duration<double>(timeout),
+                             [&]() { return !store_.detected(beam); });
+}
+
+ros::Time BreakbeamMonitor::lastRising(int beam) const
+{
+    ros::Time stamp;
+    return stamp.fromNSec(store_.lastRising(beam));
+}
+
+ros::Time BreakbeamMonitor::lastFalling(int beam) const
+{
+    ros::Time stamp;
+    return stamp.fromNSec(store_.lastFalling(beam));
+}
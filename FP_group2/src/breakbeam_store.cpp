@@ -0,0 +1,105 @@
+#include "breakbeam_store.h"
+
+BreakbeamStore::BreakbeamStore():
+        version_(0), states_(0)
+{
+    for (int beam = 0; beam < NUMBER_OF_BREAKBEAMS; beam++) {
+        sequence_[beam].store(0, std::memory_order_relaxed);
+        rising_[beam].store(0, std::memory_order_relaxed);
+        falling_[beam].store(0, std::memory_order_relaxed);
+        last_rising_[beam].store(0, std::memory_order_relaxed);
+        last_falling_[beam].store(0, std::memory_order_relaxed);
+    }
+}
+
+/**
+ * @brief New message of @p beam.
+ * @param stamp ns
+ * @return 1 on a rising edge, -1 on a falling edge, 0 if the state did not change
+ */
+int BreakbeamStore::update(int beam, bool detected, uint32_t sequence, uint64_t stamp)
+{
+    if (beam < 0 || beam >= NUMBER_OF_BREAKBEAMS)
+        return 0;
+    while (writing_.test_and_set(std::memory_order_acquire))
+        ;
+
+    // odd: update in progress. Every field below is stored with release, so a
+    // reader that loads any of them also sees this increment and retries.
+    uint64_t version = version_.fetch_add(1, std::memory_order_relaxed);
+
+    uint32_t mask = 1u << beam;
+    uint32_t states = states_.load(std::memory_order_relaxed);
+    int edge = 0;
+    if (detected && !(states & mask)) {
+        edge = 1;
+        rising_[beam].store(rising_[beam].load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        last_rising_[beam].store(stamp, std::memory_order_release);
+        states_.store(states | mask, std::memory_order_release);
+    } else if (!detected && (states & mask)) {
+        edge = -1;
+        falling_[beam].store(falling_[beam].load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        last_falling_[beam].store(stamp, std::memory_order_release);
+        states_.store(states & ~mask, std::memory_order_release);
+    }
+    sequence_[beam].store(sequence, std::memory_order_release);
+
+    version_.store(version + 2, std::memory_order_release);
+    writing_.clear(std::memory_order_release);
+    return edge;
+}
+
+bool BreakbeamStore::detected(int beam) const
+{
+    return beam >= 0 && beam < NUMBER_OF_BREAKBEAMS && (states() >> beam & 1u);
+}
+
+uint32_t BreakbeamStore::sequence(int beam) const
+{
+    return beam >= 0 && beam < NUMBER_OF_BREAKBEAMS ? sequence_[beam].load(std::memory_order_acquire) : 0;
+}
+
+/// Edges of @p beam so far, a waiter compares two readings
+uint32_t BreakbeamStore::edges(int beam, BeamEdge edge) const
+{
+    if (beam < 0 || beam >= NUMBER_OF_BREAKBEAMS)
+        return 0;
+    uint32_t rising = rising_[beam].load(std::memory_order_acquire);
+    uint32_t falling = falling_[beam].load(std::memory_order_acquire);
+    return edge == BEAM_RISING ? rising : edge == BEAM_FALLING ? falling : rising + falling;
+}
+
+uint64_t BreakbeamStore::lastRising(int beam) const
+{
+    return beam >= 0 && beam < NUMBER_OF_BREAKBEAMS ? last_rising_[beam].load(std::memory_order_acquire) : 0;
+}
+
+uint64_t BreakbeamStore::lastFalling(int beam) const
+{
+    return beam >= 0 && beam < NUMBER_OF_BREAKBEAMS ? last_falling_[beam].load(std::memory_order_acquire) : 0;
+}
+
+/// Copy of all beams as of one update, retried while a writer is active
+BeamSnapshot BreakbeamStore::snapshot() const
+{
+    BeamSnapshot copy;
+    for (;;) {
+        uint64_t before = version_.load(std::memory_order_acquire);
+        if (before & 1u)
+            continue;
+        // a value from an update still in progress was stored with release after its odd
+        // version, so these acquire loads make the check below see that version and retry
+        copy.states = states_.load(std::memory_order_acquire);
+        for (int beam = 0; beam < NUMBER_OF_BREAKBEAMS; beam++) {
+            copy.sequence[beam] = sequence_[beam].load(std::memory_order_acquire);
+            copy.rising[beam] = rising_[beam].load(std::memory_order_acquire);
+            copy.falling[beam] = falling_[beam].load(std::memory_order_acquire);
+            copy.last_rising[beam] = last_rising_[beam].load(std::memory_order_acquire);
+            copy.last_falling[beam] = last_falling_[beam].load(std::memory_order_acquire);
+        }
+        if (version_.load(std::memory_order_relaxed) == before) {
+            copy.version = before;
+            return copy;
+        }
+    }
+}
@@ -5,10 +5,8 @@
 #include <std_srvs/Trigger.h>
 
 std::array<std::array<modelparam, 36>, 17> logical_cam;
-std::array<std::array<std::array<part, 10>, 5>, 5> order_details;
-part faulty_part_agv2, faulty_part_agv1;
 
-Competition::Competition(ros::NodeHandle &node): current_score_(0)
+Competition::Competition(ros::NodeHandle &node): current_score_(0), human_aisles_(0)
 {
     node_ = node;
 }
@@ -42,60 +40,60 @@ void Competition::init() {
 
     startCompetition();
 
+    // shelves, bins, trays and cameras never move: one tf lookup batch instead of a listener per query
+    frames_.load(FrameTable::staticFrames(), FRAME_TABLE_TIMEOUT);
+
     init_.total_time += ros::Time::now().toSec() - time_called;
 
 }
 
 
-part Competition::quality_sensor_status(){
-    return faulty_part_agv2;
-}
-
-part Competition::quality_sensor_status1(){
-    return faulty_part_agv1;
-}
-
 void Competition::breakbeam_sensor_callback(const nist_gear::Proximity::ConstPtr &msg, int id)
 {
-    beam_detect[id] = msg->object_detected;
-    beam_seq2[id] = msg->header.seq;
+    breakbeams_.update(id, msg->object_detected, msg->header.seq, msg->header.stamp);
 }
 
+/**
+ * @brief Wait for the person in front of the first blocked shelf-row beam
+ * (6..15) to walk out of it, without spinning.
+ */
 void Competition::breakbeam_sensing()
 {
     for (int i =6; i<16; i++)
-        if (beam_detect[i]==true)
+        if (breakbeams_.detected(i))
         {
-            do{
-                ROS_INFO_STREAM("\nHuman is at breakbeam: "<<i);
-            }while(beam_detect[i]==true);
-            beam_seq[i]=beam_seq2[i];
-            ROS_INFO_STREAM("\n Sequence id: "<<beam_seq[i]);
+            ROS_INFO_STREAM("\nHuman is at breakbeam: "<<i);
+            if (!breakbeams_.waitWhileDetected(i, BREAKBEAM_WAIT_TIMEOUT))
+                ROS_WARN_STREAM("[Competition::breakbeam_sensing] breakbeam " << i << " still blocked after "
+                                        << BREAKBEAM_WAIT_TIMEOUT << " s");
+            ROS_INFO_STREAM("\n Sequence id: "<<breakbeams_.sequence(i));
             break;
         }
 }
 
+/// Aisles with someone at their end beams (21..28), added to the ones seen before
 void Competition::HumanDetection()
 {
+    BeamSnapshot beams = breakbeams_.snapshot();
+    int aisles = 0;
     for (auto i=0; i<4; i++)
-    {
-        if (beam_detect[i+21]==true || beam_detect[i+25]==true)
-        {
-            Human[i] = 1;
-            continue;
-        }
-    }
-    int count =0;
-    for (auto j=0; j<4; j++) {
-        if (Human[j] == 1) {
+        if (beams.detected(i+21) || beams.detected(i+25))
+            aisles |= 1 << i;
+    aisles |= human_aisles_.fetch_or(aisles);
+    for (auto j=0; j<4; j++)
+        if (aisles >> j & 1)
             ROS_INFO_STREAM("Human is at aisle: " << j + 1);
-            count++;
-        }
-    }
-    if (count)
-        Human_detected = true;
-    else
-        Human_detected = false;
+}
+
+std::array<int, 4> Competition::humans() const
+{
+    int aisles = human_aisles_.load();
+    return {aisles & 1, aisles >> 1 & 1, aisles >> 2 & 1, aisles >> 3 & 1};
+}
+
+bool Competition::humanDetected() const
+{
+    return human_aisles_.load() != 0;
 }
 
 
@@ -105,21 +103,23 @@ void Competition::logical_camera_callback(const nist_gear::LogicalCameraImage::C
     if (msg->models.size() > 0)
     {
 //        ROS_INFO_STREAM("Logical camera " + std::to_string(id) + " detected '" << msg->models.size()<< "' objects.");
-        tf2_ros::Buffer tfBuffer;
-        tf2_ros::TransformListener tfListener(tfBuffer);
-        ros::Duration timeout(5.0);
-
         geometry_msgs::TransformStamped TfStamped;
         geometry_msgs::PoseStamped pose_target,pose_real;
         std::string frame_name = "logical_camera_" + std::to_string(id) + "_frame";
 
-        try {
-            TfStamped = tfBuffer.lookupTransform("world", frame_name,
-                                                 ros::Time(0), timeout);
-        }
-        catch (tf2::TransformException &ex) {
-            ROS_WARN("%s", ex.what());
-            ros::Duration(1.0).sleep();
+        if (!frames_.lookup(frame_name, TfStamped))
+        {
+            tf2_ros::Buffer tfBuffer;
+            tf2_ros::TransformListener tfListener(tfBuffer);
+            ros::Duration timeout(5.0);
+            try {
+                TfStamped = tfBuffer.lookupTransform("world", frame_name,
+                                                     ros::Time(0), timeout);
+            }
+            catch (tf2::TransformException &ex) {
+                ROS_WARN("%s", ex.what());
+                ros::Duration(1.0).sleep();
+            }
         }
 
         for (int i = 0; i < msg->models.size(); i++) {
@@ -132,6 +132,7 @@ void Competition::logical_camera_callback(const nist_gear::LogicalCameraImage::C
             logical_cam[id][i].frame = pose_target.header.frame_id.c_str();
             logical_cam[id][i].type = msg->models[i].type.c_str();
             logical_cam[id][i].pose = pose_real.pose;
+            logical_cam[id][i].time_stamp = ros::Time::now();
         }
     }
 }
@@ -142,6 +143,9 @@ void Competition::logical_camera_callback(const nist_gear::LogicalCameraImage::C
  */
 geometry_msgs::TransformStamped Competition::shelf_pose_callback(std::string frame_name)
 {
+    if (frames_.lookup(frame_name, TfStamped))
+        return TfStamped;
+
     tf2_ros::Buffer tfBuffer;
     tf2_ros::TransformListener tfListener(tfBuffer);
     ros::Duration timeout(5.0);
@@ -173,6 +177,7 @@ double Competition::shelf_distance(std::string frame_id_1, std::string frame_id_
 
 std::vector<std::string> Competition::check_gaps()
 {
+    ros::WallTime started = ros::WallTime::now();
     std::vector<std::string> gap_id;
     for (int shelf_ind = 1;shelf_ind < 4; shelf_ind++)
     {
@@ -198,30 +203,38 @@ std::vector<std::string> Competition::check_gaps()
     }
     for(auto i: gap_id)
         ROS_INFO_STREAM(i);
+    ROS_INFO_STREAM("[Competition::check_gaps] " << (ros::WallTime::now() - started).toSec() * 1e6
+                            << " us, frame table loaded in " << frames_.loadTime() << " s");
 
     return gap_id;
 }
 
-void Competition::quality_sensor_status_callback(const nist_gear::LogicalCameraImage::ConstPtr &msg)
+/// Every faulty part in a quality control sensor message, in the world frame
+static std::vector<QcDetection> faultyParts(const nist_gear::LogicalCameraImage::ConstPtr &msg)
 {
-    if (msg->models.size() > 0)
+    std::vector<QcDetection> detections;
+    tf2::Transform sensor;
+    tf2::fromMsg(msg->pose, sensor);
+    for (auto &model : msg->models)
     {
-        faulty_part_agv2.faulty = true;
-        faulty_part_agv2.pose = msg->models[0].pose;
+        tf2::Transform part;
+        tf2::fromMsg(model.pose, part);
+        QcDetection detection;
+        detection.type = model.type;
+        tf2::toMsg(sensor * part, detection.pose);
+        detections.push_back(detection);
     }
-    else
-        faulty_part_agv2.faulty = false;
+    return detections;
+}
+
+void Competition::quality_sensor_status_callback(const nist_gear::LogicalCameraImage::ConstPtr &msg)
+{
+    quality_.update("agv2", faultyParts(msg), ros::Time::now());
 }
 
 void Competition::quality_sensor_status_callback2(const nist_gear::LogicalCameraImage::ConstPtr &msg)
 {
-    if (msg->models.size() > 0)
-    {
-        faulty_part_agv1.faulty = true;
-        faulty_part_agv1.pose = msg->models[0].pose;
-    }
-    else
-        faulty_part_agv1.faulty = false;
+    quality_.update("agv1", faultyParts(msg), ros::Time::now());
 }
 
 /// Called when a new message is received.
@@ -233,39 +246,24 @@ void Competition::competition_state_callback(const std_msgs::String::ConstPtr &
     competition_state_ = msg->data;
 }
 
-void Competition::order_callback(const nist_gear:://                            ROS_INFO_STREAM("\n Array containing the order details of part on belt \n "<<belt_part_arr[on_belt][0]<<belt_part_arr[on_belt][1]<<belt_part_arr[on_belt][2]);
-Order::ConstPtr & msg) {
+void Competition::order_callback(const nist_gear::Order::ConstPtr & msg) {
 //    ROS_INFO_STREAM("Received order:\n" << *msg);
-    received_orders_.push_back(*msg);
-    for (int i=0; i<received_orders_.size(); i++)
-    {
-        for (int j=0; j<received_orders_[i].shipments.size(); j++)
-        {
-            for (int k=0; k<received_orders_[i].shipments[j].products.size(); k++)
-            {
-                order_details[i][j][k].type = received_orders_[i].shipments[j].products[k].type;
-                order_details[i][j][k].pose.position.x = received_orders_[i].shipments[j].products[k].pose.position.x;
-                order_details[i][j][k].pose.position.y = received_orders_[i].shipments[j].products[k].pose.position.y;
-                order_details[i][j][k].pose.position.z = received_orders_[i].shipments[j].products[k].pose.position.z;
-                order_details[i][j][k].pose.orientation.x = received_orders_[i].shipments[j].products[k].pose.orientation.x;
-                order_details[i][j][k].pose.orientation.y = received_orders_[i].shipments[j].products[k].pose.orientation.y;
-                order_details[i][j][k].pose.orientation.z = received_orders_[i].shipments[j].products[k].pose.orientation.z;
-                order_details[i][j][k].pose.orientation.w = received_orders_[i].shipments[j].products[k].pose.orientation.w;
-                order_details[i][j][k].agv_id = received_orders_[i].shipments[j].agv_id;
-                order_details[i][j][k].shipment = received_orders_[i].shipments[j].shipment_type;
-                order_details[i][j][k].Shifted = false;
-            }
-        }
-    }
+    order_book_.addOrder(*msg);
 }
 
-void Competition::PartonBeltCheck(std::vector<nist_gear::Order> received, int x_loop, std::array<std::array<modelparam, 36>, 17> logicam, std::array<std::array<int, 3>, 5> &belt_part_arr, int &on_belt)
+/**
+ * @brief Products of the orders received since @p checked_orders that no bin
+ * camera sees a free part for are queued in @p belt_part_arr; @p checked_orders
+ * is advanced past them.
+ */
+void Competition::PartonBeltCheck(OrderBook &orders, int &checked_orders, int x_loop, std::array<std::array<modelparam, 36>, 17> logicam, std::array<std::array<int, 3>, 5> &belt_part_arr, int &on_belt)
 {
-    for (int i = received.size() - 1; i >= 0; i--)
+    int order_count = orders.orderCount();
+    for (int i = order_count - 1; i >= checked_orders; i--)
     {
-        for (int j = 0; j < received[i].shipments.size(); j++)
+        for (int j = 0; j < orders.shipmentCount(i); j++)
         {
-            for (int k = 0; k < received[i].shipments[j].products.size(); k++)
+            for (int k = 0; k < orders.productCount(i, j); k++)
             {
                 for (int x = 0; x < 17; x++)
                 {
@@ -276,23 +274,23 @@ void Competition::PartonBeltCheck(std::vector<nist_gear::Order> received, int x_
                     }
                     for (int y = 0; y < 36; y++)
                     {
-                        if (logicam[x][y].type == received[i].shipments[j].products[k].type)
+                        if (logicam[x][y].type == orders.product(i, j, k).type && logicam[x][y].Shifted == false)
                         {
-                            ROS_INFO_STREAM("\n" << received[i].shipments[j].products[k].type
+                            ROS_INFO_STREAM("\n" << orders.product(i, j, k).type
                                                  << " under logical camera " << x);
                             ROS_INFO_STREAM("\n Part seen " << logicam[x][y].type);
                             ROS_INFO_STREAM("\n order = " << i << ", shipment = " << j << ", products = " << k);
                             x_loop++;
                             break;
                         }
-                        if ((x == 16) && (y == 35))
+                        if ((x == 16) && (y == 35) && on_belt < int(belt_part_arr.size()))
                         {
                             belt_part_arr[on_belt][0] = i;
                             belt_part_arr[on_belt][1] = j;
                             belt_part_arr[on_belt][2] = k;
                             on_belt++;
                             ROS_INFO_STREAM(
-                                    "\n Order details of the " << received[i].shipments[j].products[k].type<<" part - i = " << i << ", j = " << j << ", k = " << k);
+                                    "\n Order details of the " << orders.product(i, j, k).type<<" part - i = " << i << ", j = " << j << ", k = " << k);
                             ROS_INFO_STREAM("\n Part is on the belt");
                             ROS_INFO_STREAM("\n Number of parts on the belt " << on_belt);
                         }
@@ -301,11 +299,27 @@ void Competition::PartonBeltCheck(std::vector<nist_gear::Order> received, int x_
             }
         }
     }
+    checked_orders = std::max(checked_orders, order_count);
+}
+
+OrderBook & Competition::getter_order_book()
+{
+    return order_book_;
+}
+
+BreakbeamMonitor & Competition::breakbeams()
+{
+    return breakbeams_;
+}
+
+FrameTable & Competition::frames()
+{
+    return frames_;
 }
 
-std::array<std::array<std::array<part, 10>, 5>, 5> Competition::getter_part_callback()
+QcRegistry & Competition::quality()
 {
-    return order_details;
+    return quality_;
 }
 
 std::array<std::array<modelparam, 36>, 17> Competition::getter_logicam_callback()
@@ -0,0 +1,52 @@
+#include "disposal_planner.h"
+
+#include <algorithm>
+
+DisposalPlanner::DisposalPlanner():
+        disposals_(0), savings_(0.0)
+{
+    // same x as agv_faulty, clear of the belt and the bins; one beside each AGV lane
+    drops_ = {{
+        {0, {1.0, 0.0}}, // agv_faulty
+        {1, {1.0, 4.0}}, // towards agv1
+        {2, {1.0, -4.0}} // towards agv2
+    }};
+}
+
+/**
+ * @brief Drop point with the shortest trip from @p from to the first of
+ * @p next that the gantry would reach after it.
+ * @param from world position of the gantry holding the faulty part
+ * @param next possible next waypoints, start_ if empty
+ * @return drop point 0..NUMBER_OF_DROP_POINTS - 1
+ */
+int DisposalPlanner::plan(point2 from, const std::vector<point2> &next)
+{
+    std::vector<point2> targets = next;
+    if (targets.empty())
+        targets.push_back(START_POSITION);
+
+    auto onward = [&targets](point2 position) {
+        double best = PartSelector::legTime(position, targets.front());
+        for (auto &target : targets)
+            best = std::min(best, PartSelector::legTime(position, target));
+        return best;
+    };
+
+    int best = 0;
+    double best_time = 0.0;
+    for (auto &drop : drops_) {
+        double time = PartSelector::legTime(from, drop.position) + onward(drop.position);
+        if (drop.drop == 0 || time < best_time) {
+            best = drop.drop;
+            best_time = time;
+        }
+    }
+
+    // what the fixed route cost: tray -> start_ -> agv_faulty -> start_ -> next
+    double fixed = PartSelector::legTime(from, START_POSITION) + 2 * PartSelector::legTime(START_POSITION, drops_[0].position)
+                   + onward(START_POSITION);
+    disposals_++;
+    savings_ += fixed - best_time;
+    return best;
+}
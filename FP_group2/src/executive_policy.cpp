@@ -0,0 +1,37 @@
+#include "executive_policy.h"
+
+#include "belt_interceptor.h"
+#include "region_predictor.h"
+
+/// AGV a product goes to, "any" becomes agv1 for the first shipment and agv2 for the others
+std::string ExecutivePolicy::assignedAgv(const std::string &agv, int shipment)
+{
+    if (agv == "any")
+        return shipment == 0 ? "agv1" : "agv2";
+    return agv;
+}
+
+/**
+ * @brief Whether the gantry goes back to the start preset before a pick.
+ * It goes straight to a bin if it already waits over the bins, and it
+ * already holds a part taken from the belt.
+ * @param over_bins gantry waits at a bin camera station (pre-positioned or after a drop)
+ */
+bool ExecutivePolicy::routeViaStart(int camera, bool over_bins, bool from_belt)
+{
+    return !from_belt && !(over_bins && camera < NUMBER_OF_BIN_CAMERAS);
+}
+
+/// A belt part just grasped goes straight on the tray if the current product needs it and the AGV is close
+bool ExecutivePolicy::placeDirectly(const std::string &part_type, const std::string &needed_type, bool needed_done,
+                                    bool agv_available, point2 station, point2 agv)
+{
+    return part_type == needed_type && !needed_done && agv_available
+           && PartSelector::legTime(station, agv) <= DIRECT_PLACE_WINDOW;
+}
+
+/// Bin for a staged belt part, StagingBuffer::reserve returns 0 when none is free
+int ExecutivePolicy::stagingBin(int reserved)
+{
+    return reserved ? reserved : STAGING_FALLBACK_BIN;
+}
@@ -0,0 +1,120 @@
+#include "feasibility_checker.h"
+#include "plan_library.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include <ros/ros.h>
+
+FeasibilityChecker::FeasibilityChecker():
+        joint_model_group_(nullptr), rejected_(0)
+{
+}
+
+/**
+ * @brief Build a robot-only planning scene; collisions in it are self
+ * collisions (links allowed to touch are taken from the SRDF).
+ */
+void FeasibilityChecker::init(const moveit::core::RobotModelConstPtr &robot_model, const std::string &group)
+{
+    group_ = group;
+    scene_.reset(new planning_scene::PlanningScene(robot_model));
+    state_.reset(new moveit::core::RobotState(robot_model));
+    state_->setToDefaultValues();
+    joint_model_group_ = robot_model->getJointModelGroup(group);
+}
+
+/**
+ * @brief Reject goals that cannot succeed without calling the planner.
+ * @return MOVE_SUCCESS if the goal is worth planning for
+ */
+MoveStatus FeasibilityChecker::check(const std::vector<double> &start, const std::vector<double> &goal)
+{
+    if (!joint_model_group_)
+        return MOVE_SUCCESS;
+
+    auto infeasible = infeasible_until_.find(motionKey(start, goal));
+    if (infeasible != infeasible_until_.end()) {
+        if (ros::WallTime::now().toSec() < infeasible->second) {
+            rejected_++;
+            return MOVE_KNOWN_INFEASIBLE;
+        }
+        infeasible_until_.erase(infeasible);
+    }
+
+    state_->setJointGroupPositions(joint_model_group_, goal);
+    if (!state_->satisfiesBounds(joint_model_group_)) {
+        rejected_++;
+        return MOVE_OUT_OF_BOUNDS;
+    }
+    state_->update();
+
+    collision_detection::CollisionRequest request;
+    collision_detection::CollisionResult result;
+    request.group_name = group_;
+    scene_->checkSelfCollision(request, result, *state_);
+    if (result.collision) {
+        rejected_++;
+        return MOVE_SELF_COLLISION;
+    }
+    return MOVE_SUCCESS;
+}
+
+/**
+ * @brief Planning time allowed for @p goal. Goals planned before get a margin
+ * over their slowest plan, others mean + 3 sigma of all plans, and until
+ * enough plans were seen the full PLANNING_TIME.
+ */
+double FeasibilityChecker::planningBudget(const std::vector<double> &goal) const
+{
+    double budget = PLANNING_TIME;
+    auto found = goal_plans_.find(goalKey(goal));
+    if (found != goal_plans_.end() && found->second.count >= 2)
+        budget = 2.0 * found->second.max;
+    else if (all_plans_.count >= 5)
+        budget = all_plans_.mean + 3.0 * std::sqrt(all_plans_.m2 / (all_plans_.count - 1));
+    return std::min(PLANNING_TIME, std::max(MIN_PLANNING_TIME, budget));
+}
+
+/**
+ * @brief Feed back the outcome of a planning request. A motion (start bucket,
+ * goal) that failed MAX_PLAN_FAILURES times in a row is rejected by check()
+ * for INFEASIBLE_GOAL_EXPIRY s; the same goal from elsewhere is still planned.
+ */
+void FeasibilityChecker::recordPlan(const std::vector<double> &start, const std::vector<double> &goal,
+                                    double planning_time, bool success)
+{
+    MotionKey motion = motionKey(start, goal);
+    if (success) {
+        addSample(all_plans_, planning_time);
+        addSample(goal_plans_[goalKey(goal)], planning_time);
+        motion_failures_.erase(motion);
+        return;
+    }
+    if (++motion_failures_[motion] >= MAX_PLAN_FAILURES) {
+        ROS_WARN_STREAM("[FeasibilityChecker::recordPlan] motion failed " << motion_failures_[motion]
+                                                                          << " times, skipping it for "
+                                                                          << INFEASIBLE_GOAL_EXPIRY << " s");
+        infeasible_until_[motion] = ros::WallTime::now().toSec() + INFEASIBLE_GOAL_EXPIRY;
+        motion_failures_.erase(motion);
+    }
+}
+
+void FeasibilityChecker::addSample(plantimes &times, double value)
+{
+    times.count++;
+    double delta = value - times.mean;
+    times.mean += delta / times.count;
+    times.m2 += delta * (value - times.mean);
+    times.max = std::max(times.max, value);
+}
+
+uint64_t FeasibilityChecker::goalKey(const std::vector<double> &goal)
+{
+    return PlanLibrary::hashValues(goal, PLAN_GOAL_RESOLUTION);
+}
+
+FeasibilityChecker::MotionKey FeasibilityChecker::motionKey(const std::vector<double> &start, const std::vector<double> &goal)
+{
+    return {PlanLibrary::hashValues(start, PLAN_START_BUCKET), goalKey(goal)};
+}
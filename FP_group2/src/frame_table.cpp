@@ -0,0 +1,84 @@
+#include "frame_table.h"
+
+#include <ros/ros.h>
+#include <tf2_ros/buffer.h>
+#include <tf2_ros/transform_listener.h>
+
+FrameTable::FrameTable():
+        loaded_(false), load_time_(0.0)
+{
+}
+
+/// shelf1..11, bin1..16, both kit trays, logical cameras 0..16 and both quality sensors
+std::vector<std::string> FrameTable::staticFrames()
+{
+    std::vector<std::string> frames;
+    for (int shelf = 1; shelf <= 11; shelf++)
+        frames.push_back("shelf" + std::to_string(shelf) + "_frame");
+    for (int bin = 1; bin <= 16; bin++)
+        frames.push_back("bin" + std::to_string(bin) + "_frame");
+    frames.push_back("kit_tray_1");
+    frames.push_back("kit_tray_2");
+    for (int camera = 0; camera <= 16; camera++)
+        frames.push_back("logical_camera_" + std::to_string(camera) + "_frame");
+    frames.push_back("quality_control_sensor_1_frame");
+    frames.push_back("quality_control_sensor_2_frame");
+    return frames;
+}
+
+/**
+ * @brief Look every frame up in one tf buffer, waiting at most @p timeout s
+ * for all of them together.
+ * @return number of frames found
+ */
+int FrameTable::load(const std::vector<std::string> &frames, double timeout)
+{
+    ros::WallTime started = ros::WallTime::now();
+    tf2_ros::Buffer buffer;
+    tf2_ros::TransformListener listener(buffer);
+
+    std::vector<std::string> missing = frames;
+    std::map<std::string, geometry_msgs::TransformStamped> found;
+    ros::WallTime deadline = started + ros::WallDuration(timeout);
+    ros::WallRate rate(50);
+    while (!missing.empty() && ros::WallTime::now() < deadline && ros::ok())
+    {
+        std::vector<std::string> still_missing;
+        for (auto &frame : missing)
+        {
+            if (buffer.canTransform("world", frame, ros::Time(0)))
+                found[frame] = buffer.lookupTransform("world", frame, ros::Time(0));
+            else
+                still_missing.push_back(frame);
+        }
+        missing.swap(still_missing);
+        if (!missing.empty())
+            rate.sleep();
+    }
+    for (auto &frame : missing)
+        ROS_WARN_STREAM("[FrameTable::load] no transform world -> " << frame);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    transforms_.insert(found.begin(), found.end());
+    loaded_ = true;
+    load_time_ = (ros::WallTime::now() - started).toSec();
+    ROS_INFO_STREAM("[FrameTable::load] " << found.size() << "/" << frames.size() << " frames in " << load_time_ << " s");
+    return found.size();
+}
+
+/// @return false if @p frame was not loaded, the caller has to ask tf itself
+bool FrameTable::lookup(const std::string &frame, geometry_msgs::TransformStamped &transform) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto entry = transforms_.find(frame);
+    if (entry == transforms_.end())
+        return false;
+    transform = entry->second;
+    return true;
+}
+
+bool FrameTable::loaded() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return loaded_;
+}
@@ -4,6 +4,24 @@
 #include <tf2_ros/transform_broadcaster.h>
 #include <tf2_ros/static_transform_broadcaster.h>
 #include <geometry_msgs/TransformStamped.h>
+#include <cmath>
+#include <sstream>
+#include <moveit/robot_state/conversions.h>
+
+/// Short printable key of a preset, used to label the retiming report
+static std::string presetKey(const PresetLocation &location) {
+    std::ostringstream key;
+    key << "[" << location.gantry.at(0) << "," << location.gantry.at(1) << "," << location.gantry.at(2) << "]";
+    return key.str();
+}
+
+/// Coarse class of a move (2 m gantry grid cells of start and goal), used to rank planners
+static std::string motionClass(const std::vector<double> &start, const std::vector<double> &goal) {
+    std::ostringstream key;
+    key << std::lround(start.at(0) / 2) << "," << std::lround(start.at(1) / 2) << " -> "
+        << std::lround(goal.at(0) / 2) << "," << std::lround(goal.at(1) / 2);
+    return key.str();
+}
 
 GantryControl::GantryControl(ros::NodeHandle & node):
         node_("/ariac/gantry"),
@@ -17,7 +35,9 @@ GantryControl::GantryControl(ros::NodeHandle & node):
         left_arm_group_(left_arm_options_),
         right_arm_group_(right_arm_options_),
         left_ee_link_group_(left_ee_link_options_),
-        right_ee_link_group_(right_ee_link_options_)
+        right_ee_link_group_(right_ee_link_options_),
+        pick_lowering_(0.0),
+        move_failure_(MOVE_SUCCESS)
 {
     ROS_INFO_STREAM("[GantryControl::GantryControl] constructor called... ");
 }
@@ -520,6 +540,14 @@ void GantryControl::init() {
     agv_faulty.left_arm = {0.0, -PI/4, 1.95, -1.16, PI/2, 0};
     agv_faulty.right_arm = {0.17,0,0,0,0,0};
 
+    agv1_drop_.gantry = {1.0, -4.0, 0};                        //Faulty part dropoff on the agv1 side
+    agv1_drop_.left_arm = {0.0, -PI/4, 1.95, -1.16, PI/2, 0};
+    agv1_drop_.right_arm = {0.17,0,0,0,0,0};
+
+    agv2_drop_.gantry = {1.0, 4.0, 0};                         //Faulty part dropoff on the agv2 side
+    agv2_drop_.left_arm = {0.0, -PI/4, 1.95, -1.16, PI/2, 0};
+    agv2_drop_.right_arm = {0.17,0,0,0,0,0};
+
     agv1_.gantry = {-0.55, -6.95, 0.15};
     agv1_.left_arm = {0.0, -PI/4, 1.95, -1.16, PI/2, 0};
     agv1_.right_arm = {0.17,0,0,0,0,0};
@@ -588,6 +616,17 @@ void GantryControl::init() {
     //--Next get the current set of joint values for the group.
 //    std::vector<double> joint_group_positions;
     current_state->copyJointGroupPositions(joint_model_group, joint_group_positions_);
+    feasibility_.init(full_robot_group_.getRobotModel(), "Full_Robot");
+
+    //--optionally race several planners for every full robot plan
+    bool planner_portfolio = false;
+    ros::param::param<bool>("~planner_portfolio", planner_portfolio, false);
+    if (planner_portfolio) {
+        std::vector<std::string> planner_ids;
+        ros::param::param<std::vector<std::string>>("~portfolio_planners", planner_ids,
+                {"RRTConnectkConfigDefault", "BiTRRTkConfigDefault", "PRMstarkConfigDefault"});
+        portfolio_.init("/ariac/gantry/plan_kinematic_path", planner_ids);
+    }
 
 
 
@@ -634,6 +673,8 @@ void GantryControl::init() {
             node_.serviceClient<nist_gear::VacuumGripperControl>("/ariac/gantry/right_arm/gripper/control");
     right_gripper_control_client.waitForExistence();
 
+    last_preset_key_ = "init";
+
     // Move robot to init position
     ROS_INFO("[GantryControl::init] Init position ready)...");
 }
@@ -802,6 +843,7 @@ bool GantryControl::pickPart(part part){
 //    ROS_INFO_STREAM("["<< part.type<<"]= " << part.pose.position.x << ", " << part.pose.position.y << "," << part.pose.position.z << "," << part.pose.orientation.x << "," << part.pose.orientation.y << "," << part.pose.orientation.z << "," << part.pose.orientation.w);
 
 
+    pick_lowering_ = 0.0;
     auto state = getGripperState("left_arm");
     if (state.enabled) {
         ROS_INFO_STREAM("[Gripper] = enabled");
@@ -815,17 +857,21 @@ bool GantryControl::pickPart(part part){
         }
         else {
             ROS_INFO_STREAM("[Gripper] = object not attached");
-            int max_attempts{5};
+            //--the part sits lower than estimated: go down a step per attempt, the caller learns the depth
             int current_attempt{0};
-            while(!state.attached) {
+            while(!state.attached && current_attempt++ < MAX_PICKING_ATTEMPTS) {
                 left_arm_group_.setPoseTarget(currentPose);
                 left_arm_group_.move();
                 ros::Duration(0.5).sleep();
+                part.pose.position.z -= GRASP_RETRY_STEP;
+                pick_lowering_ += GRASP_RETRY_STEP;
                 left_arm_group_.setPoseTarget(part.pose);
                 left_arm_group_.move();
                 activateGripper("left_arm");
                 ros::Duration(0.5).sleep();
+                state = getGripperState("left_arm");
             }
+            return state.attached;
         }
     }
     else {
@@ -841,8 +887,11 @@ bool GantryControl::pickPart(part part){
 
 }
 
-void GantryControl::placePart(part part, std::string agv){
+/// Place the part held by the left arm; @p correction (world, PlacementCorrector) is added to the target
+void GantryControl::placePart(part part, std::string agv, point2 correction){
     auto target_pose_in_tray = getTargetWorldPose(part.pose, agv);
+    target_pose_in_tray.position.x += correction.x;
+    target_pose_in_tray.position.y += correction.y;
     if (agv=="agv1")
         goToPresetLocation(agv1_);
     else
@@ -855,8 +904,10 @@ void GantryControl::placePart(part part, std::string agv){
     deactivateGripper("left_arm");
 }
 
-void GantryControl::placePartRight(part part, std::string agv){
+void GantryControl::placePartRight(part part, std::string agv, point2 correction){
     auto target_pose_in_tray = getTargetWorldPoseRight(part.pose, agv);
+    target_pose_in_tray.position.x += correction.x;
+    target_pose_in_tray.position.y += correction.y;
     target_pose_in_tray.position.z += (ABOVE_TARGET + 1.5*model_height[part.type]);
 
     right_arm_group_.setPoseTarget(target_pose_in_tray);
@@ -1112,17 +1163,9 @@ void GantryControl::moveToPresetLocation(std::map<std::string,std::vector<Preset
             location = location + "_left";
             auto vec = presetLocation[location];
             if (dir==1)
-                for (auto i=0; i<vec.size(); i++)
-                    goToPresetLocation(vec[i]);
+                followPresetChain(vec);
             else
-                for (auto i=vec.size()-1; i>=0; i--)
-                {
-                    ros::Duration(0.2).sleep();
-                    goToPresetLocation(vec[i]);
-                    ROS_INFO_STREAM("i="<<i);
-                    if (i==0)
-                        break;
-                }
+                retracePresetChain(vec);
         }
         else if ((x > 2.17 && x < 4.1) && (y > 3.1 && y < 3.6))
         {
@@ -1130,17 +1173,9 @@ void GantryControl::moveToPresetLocation(std::map<std::string,std::vector<Preset
             location = location + "_right";
             auto vec = presetLocation[location];
             if (dir==1)
-                for (auto i=0; i<vec.size(); i++)
-                    goToPresetLocation(vec[i]);
+                followPresetChain(vec);
             else
-                for (auto i=vec.size()-1; i>=0; i--)
-                {
-                    ros::Duration(0.2).sleep();
-                    goToPresetLocation(vec[i]);
-                    ROS_INFO_STREAM("i="<<i);
-                    if (i==0)
-                        break;
-                }
+                retracePresetChain(vec);
         }
 
             // Shelf 1 - logical camera 14
@@ -1150,17 +1185,9 @@ void GantryControl::moveToPresetLocation(std::map<std::string,std::vector<Preset
             location = location + "_left";
             auto vec = presetLocation[location];
             if (dir==1)
-                for (auto i=0; i<vec.size(); i++)
-                    goToPresetLocation(vec[i]);
+                followPresetChain(vec);
             else
-                for (auto i=vec.size()-1; i>=0; i--)
-                {
-                    ros::Duration(0.2).sleep();
-                    goToPresetLocation(vec[i]);
-                    ROS_INFO_STREAM("i="<<i);
-                    if (i==0)
-                        break;
-                }
+                retracePresetChain(vec);
         }
         else if ((x > 4.1 && x < 6) && (y > 3.1 && y < 3.6))
         {
@@ -1168,17 +1195,9 @@ void GantryControl::moveToPresetLocation(std::map<std::string,std::vector<Preset
             location = location + "_right";
             auto vec = presetLocation[location];
             if (dir==1)
-                for (auto i=0; i<vec.size(); i++)
-                    goToPresetLocation(vec[i]);
+                followPresetChain(vec);
             else
-                for (auto i=vec.size()-1; i>=0; i--)
-                {
-                    ros::Duration(0.2).sleep();
-                    goToPresetLocation(vec[i]);
-                    ROS_INFO_STREAM("i="<<i);
-                    if (i==0)
-                        break;
-                }
+                retracePresetChain(vec);
 
         }
 //        // Shelf 2 - logical camera 15
@@ -1188,17 +1207,9 @@ void GantryControl::moveToPresetLocation(std::map<std::string,std::vector<Preset
             location = location + "_left";
             auto vec = presetLocation[location];
             if (dir==1)
-                for (auto i=0; i<vec.size(); i++)
-                    goToPresetLocation(vec[i]);
+                followPresetChain(vec);
             else
-                for (auto i=vec.size()-1; i>=0; i--)
-                {
-                    ros::Duration(0.2).sleep();
-                    goToPresetLocation(vec[i]);
-                    ROS_INFO_STREAM("i="<<i);
-                    if (i==0)
-                        break;
-                }
+                retracePresetChain(vec);
         }
         else if ((x > 2.17 && x < 4.1) && (y > -4.1 && y < -3.6))
         {
@@ -1206,17 +1217,9 @@ void GantryControl::moveToPresetLocation(std::map<std::string,std::vector<Preset
             location = location + "_right";
             auto vec = presetLocation[location];
             if (dir==1)
-                for (auto i=0; i<vec.size(); i++)
-                    goToPresetLocation(vec[i]);
+                followPresetChain(vec);
             else
-                for (auto i=vec.size()-1; i>=0; i--)
-                {
-                    ros::Duration(0.2).sleep();
-                    goToPresetLocation(vec[i]);
-                    ROS_INFO_STREAM("i="<<i);
-                    if (i==0)
-                        break;
-                }
+                retracePresetChain(vec);
         }
 
             // Shelf 1 - logical camera 14
@@ -1226,17 +1229,9 @@ void GantryControl::moveToPresetLocation(std::map<std::string,std::vector<Preset
             location = location + "_left";
             auto vec = presetLocation[location];
             if (dir==1)
-                for (auto i=0; i<vec.size(); i++)
-                    goToPresetLocation(vec[i]);
+                followPresetChain(vec);
             else
-                for (auto i=vec.size()-1; i>=0; i--)
-                {
-                    ros::Duration(0.2).sleep();
-                    goToPresetLocation(vec[i]);
-                    ROS_INFO_STREAM("i="<<i);
-                    if (i==0)
-                        break;
-                }
+                retracePresetChain(vec);
         }
         else if ((x > 4.1 && x < 6) && (y > -4.1 && y < -3.6))
         {
@@ -1244,17 +1239,9 @@ void GantryControl::moveToPresetLocation(std::map<std::string,std::vector<Preset
             location = location + "_right";
             auto vec = presetLocation[location];
             if (dir==1)
-                for (auto i=0; i<vec.size(); i++)
-                    goToPresetLocation(vec[i]);
+                followPresetChain(vec);
             else
-                for (auto i=vec.size()-1; i>=0; i--)
-                {
-                    ros::Duration(0.2).sleep();
-                    goToPresetLocation(vec[i]);
-                    ROS_INFO_STREAM("i="<<i);
-                    if (i==0)
-                        break;
-                }
+                retracePresetChain(vec);
         }
 
         //lc5r no human
@@ -1264,17 +1251,9 @@ void GantryControl::moveToPresetLocation(std::map<std::string,std::vector<Preset
             location = location + "_right";
             auto vec = presetLocation[location];
             if (dir==1)
-                for (auto i=0; i<vec.size(); i++)
-                    goToPresetLocation(vec[i]);
+                followPresetChain(vec);
             else
-                for (auto i=vec.size()-1; i>=0; i--)
-                {
-                    ros::Duration(0.2).sleep();
-                    goToPresetLocation(vec[i]);
-                    ROS_INFO_STREAM("i="<<i);
-                    if (i==0)
-                        break;
-                }
+                retracePresetChain(vec);
         }
 
         //lc4r no human
@@ -1284,17 +1263,9 @@ void GantryControl::moveToPresetLocation(std::map<std::string,std::vector<Preset
             location = location + "_right";
             auto vec = presetLocation[location];
             if (dir==1)
-                for (auto i=0; i<vec.size(); i++)
-                    goToPresetLocation(vec[i]);
+                followPresetChain(vec);
             else
-                for (auto i=vec.size()-1; i>=0; i--)
-                {
-                    ros::Duration(0.2).sleep();
-                    goToPresetLocation(vec[i]);
-                    ROS_INFO_STREAM("i="<<i);
-                    if (i==0)
-                        break;
-                }
+                retracePresetChain(vec);
         }
 
         //lc5l no human
@@ -1305,22 +1276,12 @@ void GantryControl::moveToPresetLocation(std::map<std::string,std::vector<Preset
             auto vec = presetLocation[location];
             if (dir==1){
                 if (vec.size()==3)
-                for (auto i=0; i<vec.size(); i++)
-                    goToPresetLocation(vec[i]);
+                    followPresetChain(vec);
                 else if (vec.size()==6)
-                    for (auto i=0; i<vec.size(); i++){
-                        goToPresetLocation(vec[i]);
-                    }
+                    followPresetChain(vec);
             }
             else
-                for (auto i=vec.size()-1; i>=0; i--)
-                {
-                    ros::Duration(0.2).sleep();
-                    goToPresetLocation(vec[i]);
-                    ROS_INFO_STREAM("i="<<i);
-                    if (i==0)
-                        break;
-                }
+                retracePresetChain(vec);
         }
 
         //lc4l no human
@@ -1331,22 +1292,12 @@ void GantryControl::moveToPresetLocation(std::map<std::string,std::vector<Preset
             auto vec = presetLocation[location];
             if (dir==1){
                 if (vec.size()==3)
-                    for (auto i=0; i<vec.size(); i++)
-                        goToPresetLocation(vec[i]);
+                    followPresetChain(vec);
                 else if (vec.size()==6)
-                    for (auto i=0; i<vec.size(); i++){
-                        goToPresetLocation(vec[i]);
-                    }
+                    followPresetChain(vec);
             }
             else
-                for (auto i=vec.size()-1; i>=0; i--)
-                {
-                    ros::Duration(0.2).sleep();
-                    goToPresetLocation(vec[i]);
-                    ROS_INFO_STREAM("i="<<i);
-                    if (i==0)
-                        break;
-                }
+                retracePresetChain(vec);
         }
 
             //lc7r no human
@@ -1357,22 +1308,12 @@ void GantryControl::moveToPresetLocation(std::map<std::string,std::vector<Preset
             auto vec = presetLocation[location];
             if (dir==1){
                 if (vec.size()==3)
-                    for (auto i=0; i<vec.size(); i++)
-                        goToPresetLocation(vec[i]);
+                    followPresetChain(vec);
                 else if (vec.size()==6)
-                    for (auto i=0; i<vec.size(); i++){
-                        goToPresetLocation(vec[i]);
-                    }
+                    followPresetChain(vec);
             }
             else
-                for (auto i=vec.size()-1; i>=0; i--)
-                {
-                    ros::Duration(0.2).sleep();
-                    goToPresetLocation(vec[i]);
-                    ROS_INFO_STREAM("i="<<i);
-                    if (i==0)
-                        break;
-                }
+                retracePresetChain(vec);
         }
 
             //lc6r no human
@@ -1383,22 +1324,12 @@ void GantryControl::moveToPresetLocation(std::map<std::string,std::vector<Preset
             auto vec = presetLocation[location];
             if (dir==1){
                 if (vec.size()==3)
-                    for (auto i=0; i<vec.size(); i++)
-                        goToPresetLocation(vec[i]);
+                    followPresetChain(vec);
                 else if (vec.size()==6)
-                    for (auto i=0; i<vec.size(); i++){
-                        goToPresetLocation(vec[i]);
-                    }
+                    followPresetChain(vec);
             }
             else
-                for (auto i=vec.size()-1; i>=0; i--)
-                {
-                    ros::Duration(0.2).sleep();
-                    goToPresetLocation(vec[i]);
-                    ROS_INFO_STREAM("i="<<i);
-                    if (i==0)
-                        break;
-                }
+                retracePresetChain(vec);
         }
 
             //lc7l no human
@@ -1409,22 +1340,12 @@ void GantryControl::moveToPresetLocation(std::map<std::string,std::vector<Preset
             auto vec = presetLocation[location];
             if (dir==1){
                 if (vec.size()==3)
-                    for (auto i=0; i<vec.size(); i++)
-                        goToPresetLocation(vec[i]);
+                    followPresetChain(vec);
                 else if (vec.size()==5)
-                    for (auto i=0; i<vec.size(); i++){
-                        goToPresetLocation(vec[i]);
-                    }
+                    followPresetChain(vec);
             }
             else
-                for (auto i=vec.size()-1; i>=0; i--)
-                {
-                    ros::Duration(0.2).sleep();
-                    goToPresetLocation(vec[i]);
-                    ROS_INFO_STREAM("i="<<i);
-                    if (i==0)
-                        break;
-                }
+                retracePresetChain(vec);
         }
 
             //lc6l no human
@@ -1435,22 +1356,12 @@ void GantryControl::moveToPresetLocation(std::map<std::string,std::vector<Preset
             auto vec = presetLocation[location];
             if (dir==1){
                 if (vec.size()==3)
-                    for (auto i=0; i<vec.size(); i++)
-                        goToPresetLocation(vec[i]);
+                    followPresetChain(vec);
                 else if (vec.size()==5)
-                    for (auto i=0; i<vec.size(); i++){
-                        goToPresetLocation(vec[i]);
-                    }
+                    followPresetChain(vec);
             }
             else
-                for (auto i=vec.size()-1; i>=0; i--)
-                {
-                    ros::Duration(0.2).sleep();
-                    goToPresetLocation(vec[i]);
-                    ROS_INFO_STREAM("i="<<i);
-                    if (i==0)
-                        break;
-                }
+                retracePresetChain(vec);
         }
 
             //lc9r no human
@@ -1460,17 +1371,9 @@ void GantryControl::moveToPresetLocation(std::map<std::string,std::vector<Preset
             location = location + "_right";
             auto vec = presetLocation[location];
             if (dir==1)
-                for (auto i=0; i<vec.size(); i++)
-                    goToPresetLocation(vec[i]);
+                followPresetChain(vec);
             else
-                for (auto i=vec.size()-1; i>=0; i--)
-                {
-                    ros::Duration(0.2).sleep();
-                    goToPresetLocation(vec[i]);
-                    ROS_INFO_STREAM("i="<<i);
-                    if (i==0)
-                        break;
-                }
+                retracePresetChain(vec);
         }
 
             //lc8r no human
@@ -1480,17 +1383,9 @@ void GantryControl::moveToPresetLocation(std::map<std::string,std::vector<Preset
             location = location + "_right";
             auto vec = presetLocation[location];
             if (dir==1)
-                for (auto i=0; i<vec.size(); i++)
-                    goToPresetLocation(vec[i]);
+                followPresetChain(vec);
             else
-                for (auto i=vec.size()-1; i>=0; i--)
-                {
-                    ros::Duration(0.2).sleep();
-                    goToPresetLocation(vec[i]);
-                    ROS_INFO_STREAM("i="<<i);
-                    if (i==0)
-                        break;
-                }
+                retracePresetChain(vec);
         }
 
             //lc9l no human
@@ -1500,17 +1395,9 @@ void GantryControl::moveToPresetLocation(std::map<std::string,std::vector<Preset
             location = location + "_left";
             auto vec = presetLocation[location];
             if (dir==1)
-                for (auto i=0; i<vec.size(); i++)
-                    goToPresetLocation(vec[i]);
+                followPresetChain(vec);
             else
-                for (auto i=vec.size()-1; i>=0; i--)
-                {
-                    ros::Duration(0.2).sleep();
-                    goToPresetLocation(vec[i]);
-                    ROS_INFO_STREAM("i="<<i);
-                    if (i==0)
-                        break;
-                }
+                retracePresetChain(vec);
         }
 
             //lc8l no human
@@ -1520,23 +1407,19 @@ void GantryControl::moveToPresetLocation(std::map<std::string,std::vector<Preset
             location = location + "_left";
             auto vec = presetLocation[location];
             if (dir==1)
-                for (auto i=0; i<vec.size(); i++)
-                    goToPresetLocation(vec[i]);
+                followPresetChain(vec);
             else
-                for (auto i=vec.size()-1; i>=0; i--)
-                {
-                    ros::Duration(0.2).sleep();
-                    goToPresetLocation(vec[i]);
-                    ROS_INFO_STREAM("i="<<i);
-                    if (i==0)
-                        break;
-                }
+                retracePresetChain(vec);
         }
     }
 }
 
 
-void GantryControl::goToPresetLocation(PresetLocation location) {
+/**
+ * @brief Move the whole robot to a preset. Goals that are out of bounds, in
+ * self collision or known to be unreachable fail before planning.
+ */
+MoveStatus GantryControl::goToPresetLocation(PresetLocation location) {
     //--gantry
     joint_group_positions_.at(0) = location.gantry.at(0);
     joint_group_positions_.at(1) = location.gantry.at(1);
@@ -1558,11 +1441,315 @@ void GantryControl::goToPresetLocation(PresetLocation location) {
 
     full_robot_group_.setJointValueTarget(joint_group_positions_);
 
+    std::vector<double> start_positions;
+    full_robot_group_.getCurrentState()->copyJointGroupPositions("Full_Robot", start_positions);
+    std::string preset_key = presetKey(location);
 
     moveit::planning_interface::MoveGroupInterface::Plan my_plan;
-    bool success = (full_robot_group_.plan(my_plan) == moveit::planning_interface::MoveItErrorCode::SUCCESS);
-    if (success)
-        full_robot_group_.move();
+    bool from_library = loadCachedPlan(start_positions, my_plan);
+    if (!from_library) {
+        MoveStatus status = feasibility_.check(start_positions, joint_group_positions_);
+        if (status != MOVE_SUCCESS) {
+            ROS_ERROR_STREAM("[GantryControl::goToPresetLocation] " << preset_key << " rejected: "
+                                                                   << move_status_name[status]);
+            move_failure_ = status;
+            return status;
+        }
+
+        full_robot_group_.setPlanningTime(feasibility_.planningBudget(joint_group_positions_));
+        ros::WallTime plan_start = ros::WallTime::now();
+        bool success;
+        if (portfolio_.enabled()) {
+            moveit_msgs::MotionPlanRequest request;
+            moveit_msgs::MotionPlanResponse response;
+            full_robot_group_.constructMotionPlanRequest(request);
+            success = portfolio_.race(request, motionClass(start_positions, joint_group_positions_), response);
+            if (success) {
+                my_plan.trajectory_ = response.trajectory;
+                my_plan.start_state_ = response.trajectory_start;
+                my_plan.planning_time_ = response.planning_time;
+            }
+        }
+        else
+            success = (full_robot_group_.plan(my_plan) == moveit::planning_interface::MoveItErrorCode::SUCCESS);
+        feasibility_.recordPlan(start_positions, joint_group_positions_, (ros::WallTime::now() - plan_start).toSec(), success);
+        if (!success) {
+            ROS_ERROR_STREAM("[GantryControl::goToPresetLocation] no plan found to " << preset_key);
+            move_failure_ = MOVE_PLAN_FAILED;
+            return MOVE_PLAN_FAILED;
+        }
+
+        //--duration of the plan as returned by the default time parameterization
+        double planned_duration = 0.0;
+        if (!my_plan.trajectory_.joint_trajectory.points.empty())
+            planned_duration = my_plan.trajectory_.joint_trajectory.points.back().time_from_start.toSec();
+
+        if (retimePlan(my_plan)) {
+            auto &report = retime_report_[last_preset_key_ + " -> " + preset_key];
+            report.planned_duration += planned_duration;
+            report.retimed_duration += my_plan.trajectory_.joint_trajectory.points.back().time_from_start.toSec();
+            report.calls++;
+        }
+    }
+    //--execute the (retimed) plan instead of move(), which would plan again
+    bool executed = (full_robot_group_.execute(my_plan) == moveit::planning_interface::MoveItErrorCode::SUCCESS);
+    if (!executed) {
+        ROS_ERROR_STREAM("[GantryControl::goToPresetLocation] execution to " << preset_key << " failed");
+        move_failure_ = MOVE_EXECUTION_FAILED;
+        return MOVE_EXECUTION_FAILED;
+    }
+    if (!from_library)
+        storePlan(start_positions, my_plan);
+    last_preset_key_ = preset_key;
+    last_trajectory_ = my_plan.trajectory_;
+    return MOVE_SUCCESS;
+}
+
+/**
+ * @brief Go through a chain of presets towards a part, keeping the executed
+ * trajectory of every leg for the way back.
+ */
+void GantryControl::followPresetChain(const std::vector<PresetLocation> &chain) {
+    outbound_legs_.clear();
+    for (auto &preset : chain) {
+        if (goToPresetLocation(preset) == MOVE_SUCCESS)
+            outbound_legs_.push_back(last_trajectory_);
+        else
+            outbound_legs_.push_back(moveit_msgs::RobotTrajectory()); // planned again on the way back
+    }
+}
+
+/**
+ * @brief Return through a chain of presets walked by followPresetChain. Only
+ * the first leg is planned, since the arm moved to the part and now carries
+ * it; the other legs replay the outbound trajectories reversed in time.
+ */
+void GantryControl::retracePresetChain(const std::vector<PresetLocation> &chain) {
+    if (chain.empty())
+        return;
+    goToPresetLocation(chain.back());
+    for (int i = int(chain.size()) - 2; i >= 0; i--) {
+        //--outbound leg i+1 went from chain[i] to chain[i+1]
+        if (i + 1 < int(outbound_legs_.size()) && executeReversed(outbound_legs_[i + 1]) == MOVE_SUCCESS)
+            continue;
+        goToPresetLocation(chain[i]);
+    }
+    outbound_legs_.clear();
+}
+
+/**
+ * @brief Status of the last preset move that failed since the previous
+ * call, MOVE_SUCCESS if none did. For callers of composite moves (moveToPresetLocation) that do not
+ * see the status of each leg.
+ */
+MoveStatus GantryControl::takeMoveFailure() {
+    MoveStatus failure = move_failure_;
+    move_failure_ = MOVE_SUCCESS;
+    return failure;
+}
+
+/// Execute @p leg backwards, provided the robot stands where the leg ended
+MoveStatus GantryControl::executeReversed(const moveit_msgs::RobotTrajectory &leg) {
+    const auto &points = leg.joint_trajectory.points;
+    if (points.size() < 2 || leg.joint_trajectory.joint_names != full_robot_group_.getActiveJoints())
+        return MOVE_PLAN_FAILED;
+
+    std::vector<double> current;
+    auto current_state = full_robot_group_.getCurrentState();
+    current_state->copyJointGroupPositions("Full_Robot", current);
+    const auto &leg_end = points.back().positions;
+    if (leg_end.size() != current.size())
+        return MOVE_PLAN_FAILED;
+    for (size_t j = 0; j < current.size(); j++)
+        if (std::fabs(leg_end[j] - current[j]) > REVERSAL_START_TOLERANCE)
+            return MOVE_PLAN_FAILED;
+
+    //--p'(t) = p(T - t): same positions and accelerations, negated velocities
+    moveit::planning_interface::MoveGroupInterface::Plan reversed_plan;
+    auto &reversed = reversed_plan.trajectory_.joint_trajectory;
+    reversed.joint_names = leg.joint_trajectory.joint_names;
+    double duration = points.back().time_from_start.toSec();
+    for (auto point = points.rbegin(); point != points.rend(); ++point) {
+        trajectory_msgs::JointTrajectoryPoint reversed_point = *point;
+        reversed_point.time_from_start = ros::Duration(duration - point->time_from_start.toSec());
+        for (auto &velocity : reversed_point.velocities)
+            velocity = -velocity;
+        reversed.points.push_back(reversed_point);
+    }
+    reversed.points.front().positions = current;
+    moveit::core::robotStateToRobotStateMsg(*current_state, reversed_plan.start_state_);
+
+    if (full_robot_group_.execute(reversed_plan) != moveit::planning_interface::MoveItErrorCode::SUCCESS)
+        return MOVE_EXECUTION_FAILED;
+    last_trajectory_ = reversed_plan.trajectory_;
+    return MOVE_SUCCESS;
+}
+
+/**
+ * @brief Open the on-disk plan library. Plans stored for another scene (shelf
+ * layout) are discarded.
+ */
+bool GantryControl::openPlanLibrary(std::string path, uint64_t scene_hash) {
+    if (!plan_library_.open(path)) {
+        ROS_WARN_STREAM("[GantryControl::openPlanLibrary] cannot open " << path << ", planning every move");
+        return false;
+    }
+    plan_library_.setSceneHash(scene_hash);
+    ROS_INFO_STREAM("[GantryControl::openPlanLibrary] " << plan_library_.size() << " plans loaded from " << path);
+    return true;
+}
+
+/// Fill @p plan from the library if a plan from this start bucket to the current target is known
+bool GantryControl::loadCachedPlan(const std::vector<double> &start, moveit::planning_interface::MoveGroupInterface::Plan &plan) {
+    PlanView view;
+    if (!plan_library_.isOpen() || !plan_library_.lookup(start, joint_group_positions_, view))
+        return false;
+
+    const auto joint_names = full_robot_group_.getActiveJoints();
+    if (view.header->joint_count != joint_names.size() || view.header->point_count < 2)
+        return false;
+
+    auto &trajectory = plan.trajectory_.joint_trajectory;
+    trajectory.joint_names = joint_names;
+    trajectory.points.resize(view.header->point_count);
+    for (uint32_t i = 0; i < view.header->point_count; i++) {
+        auto &point = trajectory.points[i];
+        point.time_from_start = ros::Duration(view.time(i));
+        point.positions.assign(view.positions(i), view.positions(i) + view.header->joint_count);
+        point.velocities.assign(view.velocities(i), view.velocities(i) + view.header->joint_count);
+        point.accelerations.assign(view.accelerations(i), view.accelerations(i) + view.header->joint_count);
+    }
+    //--start exactly where the robot is, the bucket only guarantees we are close
+    trajectory.points.front().positions = start;
+    moveit::core::robotStateToRobotStateMsg(*full_robot_group_.getCurrentState(), plan.start_state_);
+    plan.planning_time_ = 0.0;
+    return true;
+}
+
+/// Append a successfully executed plan to the library
+void GantryControl::storePlan(const std::vector<double> &start, const moveit::planning_interface::MoveGroupInterface::Plan &plan) {
+    if (!plan_library_.isOpen())
+        return;
+    const auto &trajectory = plan.trajectory_.joint_trajectory;
+    const size_t joint_count = trajectory.joint_names.size();
+    if (trajectory.joint_names != full_robot_group_.getActiveJoints() || trajectory.points.size() < 2)
+        return;
+
+    std::vector<double> data;
+    data.reserve(trajectory.points.size() * (1 + 3 * joint_count));
+    for (const auto &point : trajectory.points) {
+        if (point.positions.size() != joint_count)
+            return;
+        data.push_back(point.time_from_start.toSec());
+        data.insert(data.end(), point.positions.begin(), point.positions.end());
+        for (size_t j = 0; j < joint_count; j++)
+            data.push_back(j < point.velocities.size() ? point.velocities[j] : 0.0);
+        for (size_t j = 0; j < joint_count; j++)
+            data.push_back(j < point.accelerations.size() ? point.accelerations[j] : 0.0);
+    }
+    plan_library_.store(start, joint_group_positions_, joint_count, data);
+}
+
+/**
+ * @brief Recompute the time stamps of a full robot plan with time-optimal
+ * trajectory generation, so the 3 gantry joints and the 12 arm joints share
+ * one velocity/acceleration profile bounded by the limits of the robot model.
+ * @return false if the plan was left untouched
+ */
+bool GantryControl::retimePlan(moveit::planning_interface::MoveGroupInterface::Plan &plan) {
+    if (plan.trajectory_.joint_trajectory.points.size() < 2)
+        return false;
+
+    robot_trajectory::RobotTrajectory trajectory(full_robot_group_.getRobotModel(), "Full_Robot");
+    trajectory.setRobotTrajectoryMsg(*full_robot_group_.getCurrentState(), plan.trajectory_);
+
+    if (!totg_.computeTimeStamps(trajectory, MAX_VELOCITY_SCALING, MAX_ACCELERATION_SCALING)) {
+        ROS_WARN("[GantryControl::retimePlan] time-optimal parameterization failed, keeping default timing");
+        return false;
+    }
+    trajectory.getRobotTrajectoryMsg(plan.trajectory_);
+    return !plan.trajectory_.joint_trajectory.points.empty();
+}
+
+/// Print the planned vs retimed trajectory durations for every preset pair visited
+void GantryControl::printRetimeReport() {
+    double planned = 0.0, retimed = 0.0;
+    ROS_INFO_STREAM("[GantryControl::printRetimeReport] trajectory durations (planned -> retimed):");
+    for (auto &entry : retime_report_) {
+        ROS_INFO_STREAM("  " << entry.first << " : " << entry.second.calls << " moves, "
+                             << entry.second.planned_duration << " s -> " << entry.second.retimed_duration << " s");
+        planned += entry.second.planned_duration;
+        retimed += entry.second.retimed_duration;
+    }
+    ROS_INFO_STREAM("  total : " << planned << " s -> " << retimed << " s");
+    ROS_INFO_STREAM("  rejected before planning : " << feasibility_.rejected());
+    portfolio_.printReport();
+    if (plan_library_.isOpen())
+        ROS_INFO_STREAM("  plan library : " << plan_library_.hits() << " hits, " << plan_library_.misses()
+                                            << " misses, " << plan_library_.size() << " plans stored");
+}
+
+/// Gantry position in the world frame, the torso rail joint runs along -y
+point2 GantryControl::getGantryPosition() {
+    auto joints = full_robot_group_.getCurrentJointValues();
+    return {joints.at(0), -joints.at(1)};
+}
+
+/// Belt preset whose arm configuration reaches parts of this type
+PresetLocation GantryControl::beltStation(const std::string &type) {
+    if (type.find("piston_rod_part") == 0)
+        return beltb1_;
+    if (type.find("pulley_part") == 0)
+        return beltb2_;
+    if (type.find("disk_part") == 0)
+        return beltc2_;
+    if (type.find("gasket_part") == 0)
+        return beltd2_;
+    return belta_;
+}
+
+/// Preset above bin 1..16, the left gripper drops a part near the bin center
+PresetLocation GantryControl::binStation(int bin) {
+    std::array<PresetLocation, 16> bins = {bin1_, bin2_, bin3_, bin4_, bin5_, bin6_, bin7_, bin8_,
+                                           bin9_, bin10_, bin11_, bin12_, bin13_, bin14_, bin15_, bin16_};
+    return bins.at(bin - 1);
+}
+
+/// Preset overlooking the bins watched by logical camera 0..3
+PresetLocation GantryControl::cameraStation(int camera) {
+    std::array<PresetLocation, 4> cameras = {logicam0_, logicam1_, logicam2_, logicam3_};
+    return cameras.at(camera);
+}
+
+/// Preset over faulty part drop point 0..2 of DisposalPlanner
+PresetLocation GantryControl::dropStation(int drop) {
+    std::array<PresetLocation, 3> drops = {agv_faulty, agv1_drop_, agv2_drop_};
+    return drops.at(drop);
+}
+
+/**
+ * @brief Wait at a belt station for a part predicted to pass under the left
+ * gripper, turning the gripper on at @p grasp_time.
+ * @return true if the part attached before @p deadline
+ */
+bool GantryControl::graspFromBelt(PresetLocation station, ros::Time grasp_time, ros::Time deadline) {
+    goToPresetLocation(station);
+    ros::Time now = ros::Time::now();
+    if (grasp_time > now)
+        (grasp_time - now).sleep();
+    activateGripper("left_arm");
+
+    ros::Rate poll(50);
+    while (ros::Time::now() < deadline) {
+        if (getGripperState("left_arm").attached) {
+            goToPresetLocation(station);
+            return true;
+        }
+        poll.sleep();
+    }
+    ROS_WARN_STREAM("[GantryControl::graspFromBelt] part did not attach by its predicted window");
+    deactivateGripper("left_arm");
+    return false;
 }
 
 /// Turn on vacuum gripper
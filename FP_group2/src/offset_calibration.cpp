@@ -0,0 +1,97 @@
+#include "offset_calibration.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+OffsetCalibration::OffsetCalibration():
+        updates_(0)
+{
+    // found by hand before the offsets were learnt, kept until a run measures them
+    offsets_["grasp/" + binLocation(14)] = {-0.06, 0};
+    offsets_["grasp/" + binLocation(15)] = {-0.02, 0};
+}
+
+/**
+ * @brief Offsets of previous runs, one "key value samples" line each.
+ * Values beyond CALIBRATION_MAX_OFFSET are skipped, the default stays.
+ * @return false if there is no file yet, save() will create it
+ */
+bool OffsetCalibration::load(const std::string &path)
+{
+    path_ = path;
+    std::ifstream file(path);
+    if (!file)
+        return false;
+    std::string key;
+    Offset offset;
+    while (file >> key >> offset.value >> offset.samples)
+        if (std::fabs(offset.value) <= CALIBRATION_MAX_OFFSET)
+            offsets_[key] = {offset.value, std::max(0, std::min(offset.samples, CALIBRATION_WINDOW))};
+    return true;
+}
+
+bool OffsetCalibration::save() const
+{
+    if (path_.empty())
+        return false;
+    std::ofstream file(path_, std::ios::trunc);
+    for (auto &entry : offsets_)
+        file << entry.first << " " << entry.second.value << " " << entry.second.samples << "\n";
+    return bool(file);
+}
+
+/// m to add to the camera z of a part at @p location, see binLocation() and cameraLocation()
+double OffsetCalibration::graspOffset(const std::string &location) const
+{
+    return value("grasp/" + location);
+}
+
+/**
+ * @brief A pick at @p location that used graspOffset() attached after going
+ * @p lowering m lower (GantryControl::pickLowering). It found the part at
+ * the offset minus the lowering; one that attached at once found it at the
+ * offset or higher, so the offset is pulled CALIBRATION_RAISE_STEP up and
+ * can recover from a pick that went too low. Failed picks are not observed.
+ */
+void OffsetCalibration::observeGrasp(const std::string &location, double lowering)
+{
+    auto &mean = offsets_["grasp/" + location];
+    double found = lowering > 0.0 ? mean.value - lowering : mean.value + CALIBRATION_RAISE_STEP;
+    found = std::max(-CALIBRATION_MAX_OFFSET, std::min(CALIBRATION_MAX_OFFSET, found));
+    mean.samples = std::min(mean.samples + 1, CALIBRATION_WINDOW);
+    mean.value += (found - mean.value) / mean.samples;
+    updates_++;
+}
+
+/// m to subtract from the z @p camera reports to get the true z of a part
+double OffsetCalibration::cameraOffset(int camera) const
+{
+    return value("camera/" + std::to_string(camera));
+}
+
+void OffsetCalibration::observeCamera(int camera, double offset)
+{
+    if (std::fabs(offset) > CALIBRATION_MAX_OFFSET)
+        return;
+    auto &mean = offsets_["camera/" + std::to_string(camera)];
+    mean.samples = std::min(mean.samples + 1, CALIBRATION_WINDOW);
+    mean.value += (offset - mean.value) / mean.samples;
+    updates_++;
+}
+
+std::string OffsetCalibration::binLocation(int bin)
+{
+    return "bin" + std::to_string(bin);
+}
+
+std::string OffsetCalibration::cameraLocation(int camera)
+{
+    return "logical_camera_" + std::to_string(camera);
+}
+
+double OffsetCalibration::value(const std::string &key) const
+{
+    auto offset = offsets_.find(key);
+    return offset == offsets_.end() ? 0.0 : offset->second.value;
+}
@@ -0,0 +1,92 @@
+#include "order_book.h"
+
+/**
+ * @brief Append the products of a newly received order. Only the new
+ * products are touched.
+ */
+void OrderBook::addOrder(const nist_gear::Order &order)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    int order_index = orders_.size();
+    orders_.emplace_back();
+    for (int j = 0; j < int(order.shipments.size()); j++) {
+        const auto &shipment = order.shipments[j];
+        ShipmentRef ref = {order_index, j, int(products_.size()), int(shipment.products.size())};
+        for (const auto &ordered : shipment.products) {
+            part product;
+            product.type = ordered.type;
+            product.pose = ordered.pose;
+            product.agv_id = shipment.agv_id;
+            product.shipment = shipment.shipment_type;
+            product.Shifted = false;
+            products_.push_back(product);
+        }
+        orders_.back().push_back(ref);
+        announced_.push_back(ref);
+    }
+}
+
+int OrderBook::orderCount() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return orders_.size();
+}
+
+int OrderBook::shipmentCount(int order) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return orders_.at(order).size();
+}
+
+int OrderBook::productCount(int order, int shipment) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return orders_.at(order).at(shipment).product_count;
+}
+
+/// @return -1 if the order has no such product
+int OrderBook::productId(int order, int shipment, int product) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (order < 0 || order >= int(orders_.size()) || shipment < 0 || shipment >= int(orders_[order].size()))
+        return -1;
+    const auto &ref = orders_[order][shipment];
+    if (product < 0 || product >= ref.product_count)
+        return -1;
+    return ref.first_product + product;
+}
+
+part & OrderBook::product(int id)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return products_.at(id);
+}
+
+/**
+ * @brief Product @p product of shipment @p shipment of order @p order. Like
+ * the fixed order array it replaces, a product that was not ordered reads as
+ * a blank part.
+ */
+part & OrderBook::product(int order, int shipment, int product)
+{
+    int id = productId(order, shipment, product);
+    if (id < 0) {
+        blank_ = part();
+        return blank_;
+    }
+    return this->product(id);
+}
+
+/**
+ * @brief Shipments announced since @p cursor, which is advanced past them.
+ * Start with a cursor of 0 to get every shipment.
+ */
+std::vector<ShipmentRef> OrderBook::changesSince(size_t &cursor) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<ShipmentRef> changes;
+    if (cursor < announced_.size())
+        changes.assign(announced_.begin() + cursor, announced_.end());
+    cursor = announced_.size();
+    return changes;
+}
@@ -0,0 +1,69 @@
+#include "part_selector.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+PartSelector::PartSelector():
+        selections_(0), ranking_time_(0.0)
+{
+}
+
+/// Straight gantry move, both rails travel at the same time
+double PartSelector::legTime(point2 from, point2 to)
+{
+    return std::max(std::fabs(to.x - from.x) / GANTRY_SPEED_X, std::fabs(to.y - from.y) / GANTRY_SPEED_Y);
+}
+
+/// Aisle (0..3) serving a position in the shelf area, -1 outside of it
+int PartSelector::aisleOf(point2 position)
+{
+    if (position.x > SHELF_AREA_X)
+        return -1;
+    int nearest = 0;
+    for (int aisle = 1; aisle < int(AISLE_Y.size()); aisle++)
+        if (std::fabs(position.y - AISLE_Y[aisle]) < std::fabs(position.y - AISLE_Y[nearest]))
+            nearest = aisle;
+    return nearest;
+}
+
+/**
+ * @brief Time to move between two positions. Moves into or out of the shelf
+ * area go through the aisle entry, and pay a penalty if a person is in that
+ * aisle.
+ */
+double PartSelector::travelTime(point2 from, point2 to, const std::array<int, 4> &human) const
+{
+    int from_aisle = aisleOf(from), to_aisle = aisleOf(to);
+    if (from_aisle == to_aisle)
+        return legTime(from, to) + (from_aisle >= 0 && human[from_aisle] ? HUMAN_AISLE_PENALTY : 0.0);
+
+    double time = 0.0;
+    if (from_aisle >= 0) {
+        point2 entry = {AISLE_ENTRY_X, AISLE_Y[from_aisle]};
+        time += legTime(from, entry) + (human[from_aisle] ? HUMAN_AISLE_PENALTY : 0.0);
+        from = entry;
+    }
+    if (to_aisle >= 0) {
+        point2 entry = {AISLE_ENTRY_X, AISLE_Y[to_aisle]};
+        time += legTime(entry, to) + (human[to_aisle] ? HUMAN_AISLE_PENALTY : 0.0);
+        to = entry;
+    }
+    return time + legTime(from, to);
+}
+
+/**
+ * @brief Fill in the cost of every candidate (gantry -> part -> AGV) and sort
+ * them, cheapest first.
+ */
+void PartSelector::rank(std::vector<Candidate> &candidates, point2 gantry, point2 agv, const std::array<int, 4> &human)
+{
+    auto started = std::chrono::steady_clock::now();
+    for (auto &candidate : candidates)
+        candidate.cost = travelTime(gantry, candidate.position, human) + PICK_PLACE_TIME
+                         + travelTime(candidate.position, agv, human);
+    std::stable_sort(candidates.begin(), candidates.end(),
+                     [](const Candidate &a, const Candidate &b) { return a.cost < b.cost; });
+    ranking_time_ += std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    selections_++;
+}
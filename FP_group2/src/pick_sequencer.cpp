@@ -0,0 +1,105 @@
+#include "pick_sequencer.h"
+
+#include <algorithm>
+
+PickSequencer::PickSequencer(const PartSelector &travel):
+        travel_(travel)
+{
+}
+
+/**
+ * @brief Visit order with a near minimal total travel time.
+ * @return product ids in the order they should be picked
+ */
+std::vector<int> PickSequencer::sequence(const std::vector<Visit> &visits, point2 start,
+                                         const std::array<int, 4> &human) const
+{
+    const int n = visits.size();
+    if (n == 0)
+        return {};
+
+    // step[a][b]: from the drop of visit a (a == n is the start) through the pick of b to its drop
+    std::vector<std::vector<double>> step(n + 1, std::vector<double>(n));
+    for (int a = 0; a <= n; a++)
+        for (int b = 0; b < n; b++)
+            step[a][b] = travel_.travelTime(a == n ? start : visits[a].drop, visits[b].pick, human)
+                         + travel_.travelTime(visits[b].pick, visits[b].drop, human);
+
+    auto tourCost = [&step, n](const std::vector<int> &tour) {
+        double total = 0.0;
+        int previous = n;
+        for (auto visit : tour) {
+            total += step[previous][visit];
+            previous = visit;
+        }
+        return total;
+    };
+
+    // nearest neighbour
+    std::vector<int> tour;
+    std::vector<bool> used(n, false);
+    int previous = n;
+    for (int count = 0; count < n; count++) {
+        int best = -1;
+        for (int b = 0; b < n; b++)
+            if (!used[b] && (best < 0 || step[previous][b] < step[previous][best]))
+                best = b;
+        used[best] = true;
+        tour.push_back(best);
+        previous = best;
+    }
+
+    // relocate one visit or reverse a segment while it shortens the tour
+    double best_cost = tourCost(tour);
+    for (int pass = 0; pass < SEQUENCER_MAX_PASSES; pass++) {
+        bool improved = false;
+        for (int from = 0; from < n; from++) {
+            for (int to = 0; to < n; to++) {
+                if (from == to)
+                    continue;
+                auto candidate = tour;
+                int moved = candidate[from];
+                candidate.erase(candidate.begin() + from);
+                candidate.insert(candidate.begin() + to, moved);
+                double candidate_cost = tourCost(candidate);
+                if (candidate_cost < best_cost - 1e-9) {
+                    tour.swap(candidate);
+                    best_cost = candidate_cost;
+                    improved = true;
+                }
+
+                if (from < to) {
+                    candidate = tour;
+                    std::reverse(candidate.begin() + from, candidate.begin() + to + 1);
+                    candidate_cost = tourCost(candidate);
+                    if (candidate_cost < best_cost - 1e-9) {
+                        tour.swap(candidate);
+                        best_cost = candidate_cost;
+                        improved = true;
+                    }
+                }
+            }
+        }
+        if (!improved)
+            break;
+    }
+
+    std::vector<int> product_ids;
+    for (auto visit : tour)
+        product_ids.push_back(visits[visit].product_id);
+    return product_ids;
+}
+
+/// Total travel time of visiting @p order (indices into @p visits) from @p start
+double PickSequencer::cost(const std::vector<Visit> &visits, const std::vector<int> &order, point2 start,
+                           const std::array<int, 4> &human) const
+{
+    double total = 0.0;
+    point2 position = start;
+    for (auto index : order) {
+        total += travel_.travelTime(position, visits[index].pick, human)
+                 + travel_.travelTime(visits[index].pick, visits[index].drop, human);
+        position = visits[index].drop;
+    }
+    return total;
+}
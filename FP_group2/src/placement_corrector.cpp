@@ -0,0 +1,53 @@
+#include "placement_corrector.h"
+
+#include <algorithm>
+#include <cmath>
+
+PlacementCorrector::PlacementCorrector():
+        placements_(0), regrasps_(0)
+{
+}
+
+/**
+ * @brief World offset to add to the target of the next placement.
+ * @return {0, 0} until the arm was seen placing on this AGV
+ */
+point2 PlacementCorrector::correction(const std::string &arm, const std::string &agv, const std::string &type) const
+{
+    auto bias = by_type_.find(arm + "/" + agv + "/" + type);
+    if (bias == by_type_.end()) {
+        bias = by_arm_.find(arm + "/" + agv);
+        if (bias == by_arm_.end())
+            return {0.0, 0.0};
+    }
+    auto clamp = [](double value) {
+        return std::max(-PLACEMENT_MAX_CORRECTION, std::min(PLACEMENT_MAX_CORRECTION, value));
+    };
+    return {clamp(-bias->second.mean.x), clamp(-bias->second.mean.y)};
+}
+
+/**
+ * @brief A part placed at @p target + @p applied was seen at @p observed.
+ * @return true if it is more than PLACEMENT_TOLERANCE off @p target and has to be placed again
+ */
+bool PlacementCorrector::observe(const std::string &arm, const std::string &agv, const std::string &type,
+                                 point2 target, point2 applied, point2 observed)
+{
+    placements_++;
+    point2 error = {observed.x - target.x - applied.x, observed.y - target.y - applied.y};
+    if (std::fabs(error.x) < PLACEMENT_OUTLIER && std::fabs(error.y) < PLACEMENT_OUTLIER) {
+        add(by_type_[arm + "/" + agv + "/" + type], error);
+        add(by_arm_[arm + "/" + agv], error);
+    }
+    bool misplaced = std::fabs(observed.x - target.x) > PLACEMENT_TOLERANCE
+                     || std::fabs(observed.y - target.y) > PLACEMENT_TOLERANCE;
+    regrasps_ += misplaced;
+    return misplaced;
+}
+
+void PlacementCorrector::add(Bias &bias, point2 error)
+{
+    bias.samples = std::min(bias.samples + 1, PLACEMENT_WINDOW);
+    bias.mean.x += (error.x - bias.mean.x) / bias.samples;
+    bias.mean.y += (error.y - bias.mean.y) / bias.samples;
+}
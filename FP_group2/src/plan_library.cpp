@@ -0,0 +1,248 @@
+#include "plan_library.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+const uint32_t PLAN_LIBRARY_MAGIC = 0x4c504650; // "FPPL"
+const uint32_t PLAN_LIBRARY_VERSION = 1;
+
+struct FileHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t reserved;
+};
+
+size_t recordSize(const PlanRecordHeader &header) {
+    return sizeof(PlanRecordHeader)
+           + sizeof(double) * header.point_count * (1 + 3 * static_cast<size_t>(header.joint_count));
+}
+
+bool writeAll(int fd, const void* buffer, size_t size) {
+    const char* bytes = static_cast<const char*>(buffer);
+    while (size > 0) {
+        ssize_t written = ::write(fd, bytes, size);
+        if (written <= 0)
+            return false;
+        bytes += written;
+        size -= written;
+    }
+    return true;
+}
+}
+
+PlanLibrary::PlanLibrary():
+        fd_(-1), map_(nullptr), map_size_(0), scene_hash_(0), hits_(0), misses_(0)
+{
+}
+
+PlanLibrary::~PlanLibrary()
+{
+    close();
+}
+
+/**
+ * @brief Open (or create) the library file and index the plans it holds.
+ */
+bool PlanLibrary::open(const std::string &path)
+{
+    close();
+    path_ = path;
+    fd_ = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd_ < 0)
+        return false;
+
+    struct stat st;
+    if (fstat(fd_, &st) != 0) {
+        close();
+        return false;
+    }
+    if (st.st_size < static_cast<off_t>(sizeof(FileHeader))) {
+        FileHeader header = {PLAN_LIBRARY_MAGIC, PLAN_LIBRARY_VERSION, 0};
+        if (ftruncate(fd_, 0) != 0 || !writeAll(fd_, &header, sizeof(header))) {
+            close();
+            return false;
+        }
+    }
+    if (!remap()) {
+        close();
+        return false;
+    }
+
+    FileHeader header;
+    std::memcpy(&header, map_, sizeof(header));
+    if (header.magic != PLAN_LIBRARY_MAGIC || header.version != PLAN_LIBRARY_VERSION) {
+        // Unknown layout, start over rather than misreading it
+        header = {PLAN_LIBRARY_MAGIC, PLAN_LIBRARY_VERSION, 0};
+        if (ftruncate(fd_, 0) != 0 || lseek(fd_, 0, SEEK_SET) != 0
+            || !writeAll(fd_, &header, sizeof(header)) || !remap()) {
+            close();
+            return false;
+        }
+    }
+    buildIndex();
+    return true;
+}
+
+void PlanLibrary::close()
+{
+    if (map_)
+        munmap(const_cast<char*>(map_), map_size_);
+    map_ = nullptr;
+    map_size_ = 0;
+    if (fd_ >= 0)
+        ::close(fd_);
+    fd_ = -1;
+    index_.clear();
+}
+
+/**
+ * @brief Plans are only served for the current scene. Switching scenes drops
+ * the plans of every other scene from the file.
+ */
+void PlanLibrary::setSceneHash(uint64_t scene_hash)
+{
+    if (scene_hash == scene_hash_)
+        return;
+    scene_hash_ = scene_hash;
+    if (isOpen()) {
+        compact();
+        buildIndex();
+    }
+}
+
+bool PlanLibrary::lookup(const std::vector<double> &start, const std::vector<double> &goal, PlanView &view) const
+{
+    Key key = {hashValues(start, PLAN_START_BUCKET), hashValues(goal, PLAN_GOAL_RESOLUTION), scene_hash_};
+    auto found = index_.find(key);
+    if (!map_ || found == index_.end() || found->second + sizeof(PlanRecordHeader) > map_size_) {
+        misses_++;
+        return false;
+    }
+    view.header = reinterpret_cast<const PlanRecordHeader*>(map_ + found->second);
+    view.data = reinterpret_cast<const double*>(map_ + found->second + sizeof(PlanRecordHeader));
+    hits_++;
+    return true;
+}
+
+/**
+ * @brief Append a plan. @p data holds point_count * (1 + 3 * joint_count)
+ * values laid out as described in PlanRecordHeader.
+ */
+bool PlanLibrary::store(const std::vector<double> &start, const std::vector<double> &goal,
+                        uint32_t joint_count, const std::vector<double> &data)
+{
+    if (!isOpen() || joint_count == 0 || data.empty() || data.size() % (1 + 3 * joint_count) != 0)
+        return false;
+
+    PlanRecordHeader header;
+    header.start_bucket = hashValues(start, PLAN_START_BUCKET);
+    header.goal_key = hashValues(goal, PLAN_GOAL_RESOLUTION);
+    header.scene_hash = scene_hash_;
+    header.point_count = data.size() / (1 + 3 * joint_count);
+    header.joint_count = joint_count;
+
+    off_t offset = lseek(fd_, 0, SEEK_END);
+    if (offset < 0 || !writeAll(fd_, &header, sizeof(header))
+        || !writeAll(fd_, data.data(), data.size() * sizeof(double))) {
+        if (offset >= 0 && ftruncate(fd_, offset) != 0)
+            perror("[PlanLibrary::store] ftruncate");
+        return false;
+    }
+    if (!remap())
+        return false;
+    // a newer plan for the same key replaces the older one
+    index_[{header.start_bucket, header.goal_key, header.scene_hash}] = offset;
+    return true;
+}
+
+/// FNV-1a over the values quantized to @p resolution
+uint64_t PlanLibrary::hashValues(const std::vector<double> &values, double resolution)
+{
+    uint64_t hash = 14695981039346656037ULL;
+    for (auto value : values) {
+        int64_t bucket = static_cast<int64_t>(std::llround(value / resolution));
+        for (int byte = 0; byte < 8; byte++) {
+            hash ^= static_cast<uint64_t>(bucket >> (8 * byte)) & 0xff;
+            hash *= 1099511628211ULL;
+        }
+    }
+    return hash;
+}
+
+/// Map the whole file again after it grew. On failure the library is closed, no stale offsets survive.
+bool PlanLibrary::remap()
+{
+    struct stat st;
+    if (fstat(fd_, &st) != 0) {
+        close();
+        return false;
+    }
+    if (map_)
+        munmap(const_cast<char*>(map_), map_size_);
+    map_ = nullptr;
+    map_size_ = st.st_size;
+    void* map = mmap(nullptr, map_size_, PROT_READ, MAP_SHARED, fd_, 0);
+    if (map == MAP_FAILED) {
+        close();
+        return false;
+    }
+    map_ = static_cast<const char*>(map);
+    return true;
+}
+
+/// Walk the record headers of the current scene; trajectories are not read
+void PlanLibrary::buildIndex()
+{
+    index_.clear();
+    size_t offset = sizeof(FileHeader);
+    while (offset + sizeof(PlanRecordHeader) <= map_size_) {
+        PlanRecordHeader header;
+        std::memcpy(&header, map_ + offset, sizeof(header));
+        size_t size = recordSize(header);
+        if (header.joint_count == 0 || offset + size > map_size_)
+            break; // truncated tail from an interrupted append
+        if (header.scene_hash == scene_hash_)
+            index_[{header.start_bucket, header.goal_key, header.scene_hash}] = offset;
+        offset += size;
+    }
+}
+
+/// Rewrite the file keeping only the records of the current scene
+bool PlanLibrary::compact()
+{
+    std::string tmp_path = path_ + ".tmp";
+    int tmp_fd = ::open(tmp_path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (tmp_fd < 0)
+        return false;
+
+    bool ok = writeAll(tmp_fd, map_, sizeof(FileHeader));
+    size_t offset = sizeof(FileHeader);
+    while (ok && offset + sizeof(PlanRecordHeader) <= map_size_) {
+        PlanRecordHeader header;
+        std::memcpy(&header, map_ + offset, sizeof(header));
+        size_t size = recordSize(header);
+        if (header.joint_count == 0 || offset + size > map_size_)
+            break;
+        if (header.scene_hash == scene_hash_)
+            ok = writeAll(tmp_fd, map_ + offset, size);
+        offset += size;
+    }
+    if (!ok || std::rename(tmp_path.c_str(), path_.c_str()) != 0) {
+        ::close(tmp_fd);
+        std::remove(tmp_path.c_str());
+        return false;
+    }
+
+    if (map_)
+        munmap(const_cast<char*>(map_), map_size_);
+    map_ = nullptr;
+    ::close(fd_);
+    fd_ = tmp_fd;
+    return remap();
+}
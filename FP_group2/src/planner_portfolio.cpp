@@ -0,0 +1,173 @@
+#include "planner_portfolio.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+#include <ros/ros.h>
+#include <moveit_msgs/GetMotionPlan.h>
+#include <moveit_msgs/MoveItErrorCodes.h>
+
+/// Shared between the racing calls and the caller, outlives the race itself
+struct RaceState {
+    std::mutex mutex;
+    std::condition_variable finished;
+    int pending = 0;
+    int winner = -1;
+    moveit_msgs::MotionPlanResponse response;
+    ros::WallTime sent;
+    ros::WallTime won; // when the winner came back
+    ros::WallTime last_back; // when the last call came back
+    double busy = 0.0; // summed duration of all calls [s]
+};
+
+PlannerPortfolio::PlannerPortfolio()
+{
+}
+
+PlannerPortfolio::~PlannerPortfolio()
+{
+    joinPrevious();
+}
+
+void PlannerPortfolio::init(const std::string &service_name, const std::vector<std::string> &planner_ids)
+{
+    service_name_ = service_name;
+    planner_ids_ = planner_ids;
+}
+
+/**
+ * @brief Send @p request once per active planner and return the first
+ * successful response. Planners still running when a winner arrives keep
+ * going until their budget runs out; their responses are dropped and their
+ * calls are joined at the start of the next race.
+ */
+bool PlannerPortfolio::race(const moveit_msgs::MotionPlanRequest &request, const std::string &motion_class,
+                            moveit_msgs::MotionPlanResponse &response)
+{
+    joinPrevious();
+
+    auto planners = activePlanners(motion_class);
+    double budget = plannerBudget(request, motion_class);
+    auto state = std::make_shared<RaceState>();
+    state->pending = planners.size();
+    state->sent = ros::WallTime::now();
+    previous_.motion_class = motion_class;
+    previous_.state = state;
+
+    for (size_t i = 0; i < planners.size(); i++) {
+        moveit_msgs::GetMotionPlan srv;
+        srv.request.motion_plan_request = request;
+        srv.request.motion_plan_request.planner_id = planners[i];
+        srv.request.motion_plan_request.allowed_planning_time = budget;
+        std::string service_name = service_name_;
+        previous_.calls.push_back(std::async(std::launch::async, [state, srv, service_name, i]() mutable {
+            // a fresh connection per call, so a losing planner never blocks the winner
+            ros::WallTime start = ros::WallTime::now();
+            bool solved = ros::service::call(service_name, srv)
+                          && srv.response.motion_plan_response.error_code.val == moveit_msgs::MoveItErrorCodes::SUCCESS;
+            ros::WallTime back = ros::WallTime::now();
+            std::lock_guard<std::mutex> lock(state->mutex);
+            state->pending--;
+            state->busy += (back - start).toSec();
+            state->last_back = back;
+            if (solved && state->winner < 0) {
+                state->winner = i;
+                state->won = back;
+                state->response = srv.response.motion_plan_response;
+            }
+            state->finished.notify_all();
+        }));
+    }
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->finished.wait_for(lock, std::chrono::duration<double>(budget + 1.0),
+                             [&state] { return state->winner >= 0 || state->pending == 0; });
+    races_[motion_class]++;
+    if (state->winner < 0) {
+        ROS_WARN_STREAM("[PlannerPortfolio::race] no planner solved " << motion_class);
+        return false;
+    }
+    wins_[motion_class][planners[state->winner]]++;
+    response = state->response;
+    slowest_win_[motion_class] = std::max(slowest_win_[motion_class], response.planning_time);
+    ROS_INFO_STREAM("[PlannerPortfolio::race] " << planners[state->winner] << " won " << motion_class
+                                                << " in " << response.planning_time << " s");
+    return true;
+}
+
+/**
+ * @brief Wait for the calls of the previous race and account for how long
+ * they ran together and past the winner.
+ */
+void PlannerPortfolio::joinPrevious()
+{
+    for (auto &call : previous_.calls)
+        call.wait();
+    if (previous_.state) {
+        auto &state = *previous_.state;
+        busy_[previous_.motion_class] += state.busy;
+        wall_[previous_.motion_class] += (state.last_back - state.sent).toSec();
+        if (state.winner >= 0)
+            past_winner_[previous_.motion_class] += (state.last_back - state.won).toSec();
+    }
+    previous_.calls.clear();
+    previous_.state.reset();
+}
+
+/**
+ * @brief Planning time each planner gets for @p motion_class: the request's
+ * own budget until the class has PORTFOLIO_MIN_RACES races, then
+ * PORTFOLIO_BUDGET_MARGIN times its slowest win.
+ */
+double PlannerPortfolio::plannerBudget(const moveit_msgs::MotionPlanRequest &request,
+                                       const std::string &motion_class) const
+{
+    auto races = races_.find(motion_class);
+    auto slowest = slowest_win_.find(motion_class);
+    if (races == races_.end() || races->second < PORTFOLIO_MIN_RACES || slowest == slowest_win_.end())
+        return request.allowed_planning_time;
+    return std::min(request.allowed_planning_time,
+                    std::max(PORTFOLIO_MIN_BUDGET, PORTFOLIO_BUDGET_MARGIN * slowest->second));
+}
+
+/**
+ * @brief Planners to launch for @p motion_class. After PORTFOLIO_MIN_RACES
+ * races, planners with less than PORTFOLIO_MIN_WIN_SHARE of the wins are left out.
+ */
+std::vector<std::string> PlannerPortfolio::activePlanners(const std::string &motion_class) const
+{
+    auto races = races_.find(motion_class);
+    auto wins = wins_.find(motion_class);
+    if (races == races_.end() || races->second < PORTFOLIO_MIN_RACES || wins == wins_.end())
+        return planner_ids_;
+
+    std::vector<std::string> active;
+    for (auto &planner : planner_ids_) {
+        auto won = wins->second.find(planner);
+        if (won != wins->second.end() && won->second >= PORTFOLIO_MIN_WIN_SHARE * races->second)
+            active.push_back(planner);
+    }
+    if (active.empty())
+        return planner_ids_;
+    return active;
+}
+
+void PlannerPortfolio::printReport()
+{
+    joinPrevious();
+    for (auto &motion_class : races_) {
+        ROS_INFO_STREAM("  portfolio " << motion_class.first << " : " << motion_class.second << " races");
+        // overlap near 1 means move_group served the planners one at a time
+        double wall = wall_[motion_class.first];
+        ROS_INFO_STREAM("    overlap " << (wall > 0 ? busy_[motion_class.first] / wall : 0.0)
+                                       << ", losers ran " << past_winner_[motion_class.first]
+                                       << " s past the winners");
+        auto wins = wins_.find(motion_class.first);
+        if (wins == wins_.end())
+            continue;
+        for (auto &planner : wins->second)
+            ROS_INFO_STREAM("    " << planner.first << " won " << planner.second);
+    }
+}
@@ -0,0 +1,194 @@
+#include "qc_registry.h"
+
+#include <chrono>
+#include <cmath>
+
+namespace {
+
+double distanceXY(const geometry_msgs::Pose &a, const geometry_msgs::Pose &b)
+{
+    return std::hypot(a.position.x - b.position.x, a.position.y - b.position.y);
+}
+
+/// Index of the placement closest to @p pose within QC_MATCH_RADIUS, -1 if none
+int nearestSlot(const std::vector<QcSlot> &slots, const geometry_msgs::Pose &pose)
+{
+    int nearest = -1;
+    for (int s = 0; s < int(slots.size()); s++)
+        if (distanceXY(slots[s].target, pose) <= QC_MATCH_RADIUS
+            && (nearest < 0 || distanceXY(slots[s].target, pose) < distanceXY(slots[nearest].target, pose)))
+            nearest = s;
+    return nearest;
+}
+
+}
+
+QcRegistry::QcRegistry():
+        faulty_seen_(0)
+{
+}
+
+/**
+ * @brief New message of the sensor over @p agv: every faulty part it sees now.
+ * A detection keeps its first_seen while it stays where it was.
+ */
+void QcRegistry::update(const std::string &agv, const std::vector<QcDetection> &faulty, ros::Time stamp)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto &previous = detections_[agv];
+        std::vector<QcDetection> current;
+        for (auto detection : faulty) {
+            detection.first_seen = detection.last_seen = stamp;
+            bool known = false;
+            for (auto &seen : previous)
+                if (seen.type == detection.type && distanceXY(seen.pose, detection.pose) <= QC_MATCH_RADIUS) {
+                    detection.first_seen = seen.first_seen;
+                    known = true;
+                    break;
+                }
+            faulty_seen_ += !known;
+            current.push_back(detection);
+        }
+        previous.swap(current);
+        last_update_[agv] = stamp;
+    }
+    updated_.notify_all();
+}
+
+/// A product was just placed at @p target (world) on the tray of @p agv
+void QcRegistry::placed(const std::string &agv, const Task &task, const geometry_msgs::Pose &target, ros::Time stamp)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto &slots = slots_[agv];
+    for (auto slot = slots.begin(); slot != slots.end(); ++slot)
+        if (slot->task.product_id == task.product_id) {
+            slots.erase(slot);
+            break;
+        }
+    QcSlot slot;
+    slot.task = task;
+    slot.agv = agv;
+    slot.target = target;
+    slot.placed = stamp;
+    slot.status = QC_PENDING;
+    slots.push_back(slot);
+}
+
+/// The part of @p product_id was taken off the tray
+void QcRegistry::removed(const std::string &agv, int product_id)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto &slots = slots_[agv];
+    for (auto slot = slots.begin(); slot != slots.end(); ++slot)
+        if (slot->task.product_id == product_id) {
+            slots.erase(slot);
+            return;
+        }
+}
+
+/// Verdict of one placement, mutex_ held
+QcSlot QcRegistry::classify(const QcSlot &slot) const
+{
+    QcSlot result = slot;
+    auto update = last_update_.find(slot.agv);
+    if (update == last_update_.end() || update->second < slot.placed + ros::Duration(QC_SETTLE_TIME)) {
+        result.status = QC_PENDING;
+        return result;
+    }
+    result.status = QC_GOOD;
+    auto &slots = slots_.at(slot.agv);
+    auto detections = detections_.find(slot.agv);
+    if (detections == detections_.end())
+        return result;
+    for (auto &detection : detections->second) {
+        int nearest = nearestSlot(slots, detection.pose);
+        if (nearest >= 0 && slots[nearest].task.product_id == slot.task.product_id) {
+            result.status = QC_FAULTY;
+            result.detection = detection;
+            break;
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief What the sensor says about @p product_id right now.
+ * @return status QC_PENDING if no message since the placement, task.product_id -1 if it was never placed
+ */
+QcSlot QcRegistry::verdict(const std::string &agv, int product_id) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto slots = slots_.find(agv);
+    if (slots != slots_.end())
+        for (auto &slot : slots->second)
+            if (slot.task.product_id == product_id)
+                return classify(slot);
+    QcSlot unknown;
+    unknown.task.product_id = -1;
+    unknown.agv = agv;
+    unknown.status = QC_PENDING;
+    return unknown;
+}
+
+/**
+ * @brief Wait for the verdict on @p product_id, at most @p timeout s.
+ * @return status QC_PENDING on timeout
+ */
+QcSlot QcRegistry::await(const std::string &agv, int product_id, double timeout)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    QcSlot result;
+    result.task.product_id = -1;
+    result.agv = agv;
+    result.status = QC_PENDING;
+    updated_.wait_for(lock, std::chrono::duration<double>(timeout), [&]() {
+        for (auto &slot : slots_[agv])
+            if (slot.task.product_id == product_id) {
+                result = classify(slot);
+                return result.status != QC_PENDING;
+            }
+        return false;
+    });
+    return result;
+}
+
+/**
+ * @brief await() on its own thread, so the caller can go on with the next
+ * pick and collect the verdict later.
+ */
+std::future<QcSlot> QcRegistry::verdictAsync(const std::string &agv, int product_id, double timeout)
+{
+    return std::async(std::launch::async, &QcRegistry::await, this, agv, product_id, timeout);
+}
+
+/**
+ * @brief Every faulty part on the tray of @p agv with the product it stands
+ * for; parts no placement explains come with task.product_id -1.
+ */
+std::vector<QcSlot> QcRegistry::faulty(const std::string &agv) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<QcSlot> result;
+    auto detections = detections_.find(agv);
+    if (detections == detections_.end())
+        return result;
+    static const std::vector<QcSlot> none;
+    auto slots = slots_.find(agv);
+    auto &placed = slots == slots_.end() ? none : slots->second;
+    for (auto &detection : detections->second) {
+        int nearest = nearestSlot(placed, detection.pose);
+        QcSlot slot;
+        if (nearest >= 0) {
+            slot = placed[nearest];
+        } else {
+            slot.task.product_id = -1;
+            slot.agv = agv;
+            slot.target = detection.pose;
+        }
+        slot.status = QC_FAULTY;
+        slot.detection = detection;
+        result.push_back(slot);
+    }
+    return result;
+}
@@ -0,0 +1,42 @@
+#include "region_predictor.h"
+
+RegionPredictor::RegionPredictor():
+        hits_(0), misses_(0)
+{
+}
+
+/**
+ * @brief Most likely bin camera for the next pick.
+ * @param cameras for each upcoming product in run order, the cameras seeing a
+ * part it could use
+ * @return camera 0..3, -1 if no upcoming product is in the bins
+ */
+int RegionPredictor::predict(const std::vector<std::vector<int>> &cameras) const
+{
+    std::array<double, NUMBER_OF_BIN_CAMERAS> score = {};
+    for (int n = 0; n < int(cameras.size()) && n < REGION_LOOKAHEAD; n++) {
+        if (cameras[n].empty())
+            continue;
+        double weight = 1.0 / (n + 1) / cameras[n].size();
+        for (auto camera : cameras[n])
+            if (camera >= 0 && camera < NUMBER_OF_BIN_CAMERAS)
+                score[camera] += weight;
+    }
+
+    int best = -1;
+    for (int camera = 0; camera < NUMBER_OF_BIN_CAMERAS; camera++)
+        if (score[camera] > 0.0 && (best < 0 || score[camera] > score[best]))
+            best = camera;
+    return best;
+}
+
+/// Compare a prediction with the camera the next part was taken from
+void RegionPredictor::record(int predicted, int used)
+{
+    if (predicted < 0)
+        return;
+    if (predicted == used)
+        hits_++;
+    else
+        misses_++;
+}
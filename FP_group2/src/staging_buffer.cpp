@@ -0,0 +1,85 @@
+#include "staging_buffer.h"
+
+#include <cmath>
+
+StagingBuffer::StagingBuffer():
+        staged_(0)
+{
+    // same bin areas GantryControl::moveToPresetLocation recognises when picking
+    slots_ = {{
+        {1, 1, {2.65, 1.22}, true},
+        {2, 1, {3.6, 1.25}, false}, // no pick area matches bin 2
+        {3, 0, {4.5, 1.3}, true},
+        {4, 0, {5.36, 1.3}, true},
+        {5, 1, {2.6, 2.1}, true},
+        {6, 1, {3.5, 2.15}, true},
+        {7, 0, {4.55, 2.15}, true},
+        {8, 0, {5.4, 2.15}, true},
+        {9, 2, {2.6, -1.3}, true},
+        {10, 2, {3.55, -1.3}, true},
+        {11, 3, {4.45, -1.3}, true},
+        {12, 3, {5.4, -1.3}, true},
+        {13, 2, {2.6, -2.12}, true},
+        {14, 2, {3.55, -2.12}, true},
+        {15, 3, {4.45, -2.12}, true},
+        {16, 3, {5.4, -2.12}, true}
+    }};
+}
+
+/// Bin (1..16) containing a world position, 0 if none
+int StagingBuffer::binAt(point2 position) const
+{
+    for (auto &slot : slots_)
+        if (std::fabs(position.x - slot.center.x) < BIN_HALF_WIDTH_X
+            && std::fabs(position.y - slot.center.y) < BIN_HALF_WIDTH_Y)
+            return slot.bin;
+    return 0;
+}
+
+/**
+ * @brief Free bin closest to @p agv.
+ * @param inventory world positions of every part known to be in the bins
+ * @return bin number, 0 if every bin is taken
+ */
+int StagingBuffer::nearest(point2 agv, const std::vector<point2> &inventory) const
+{
+    int best = 0;
+    double best_time = 0.0;
+    for (auto &slot : slots_) {
+        if (!isFree(slot, inventory))
+            continue;
+        double time = PartSelector::legTime(slot.center, agv);
+        if (best == 0 || time < best_time) {
+            best = slot.bin;
+            best_time = time;
+        }
+    }
+    return best;
+}
+
+/// Choose the bin for a part about to be staged, see nearest()
+int StagingBuffer::reserve(point2 agv, const std::vector<point2> &inventory)
+{
+    int best = nearest(agv, inventory);
+    if (best)
+        staged_++;
+    return best;
+}
+
+int StagingBuffer::freeSlots(const std::vector<point2> &inventory) const
+{
+    int free = 0;
+    for (auto &slot : slots_)
+        free += isFree(slot, inventory);
+    return free;
+}
+
+bool StagingBuffer::isFree(const StagingSlot &slot, const std::vector<point2> &inventory) const
+{
+    if (!slot.usable)
+        return false;
+    for (auto &position : inventory)
+        if (binAt(position) == slot.bin)
+            return false;
+    return true;
+}
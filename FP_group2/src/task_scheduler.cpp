@@ -0,0 +1,138 @@
+#include "task_scheduler.h"
+
+#include <algorithm>
+
+TaskScheduler::TaskScheduler(int max_attempts):
+        max_attempts_(max_attempts), sequence_(0), last_priority_(-1), preemptions_(0), dropped_(0)
+{
+}
+
+/**
+ * @brief Queue one task per product of a shipment. Products
+ * first_product .. first_product + product_count - 1 are its order book ids.
+ */
+void TaskScheduler::addShipment(int order, int shipment, int first_product, int product_count, int priority)
+{
+    remaining_[{order, shipment}] = product_count;
+    for (int k = 0; k < product_count; k++) {
+        Task task = {order, shipment, k, first_product + k, priority, 0, sequence_++};
+        shipment_of_[task.product_id] = {order, shipment};
+        queue_.push(task);
+    }
+}
+
+/**
+ * @brief Take the highest priority task that is not complete yet.
+ * @return false when there is nothing left to do
+ */
+bool TaskScheduler::next(Task &task)
+{
+    skipDone();
+    if (queue_.empty())
+        return false;
+    task = queue_.top();
+    queue_.pop();
+    if (task.priority > last_priority_ && last_priority_ >= 0)
+        preemptions_++;
+    last_priority_ = task.priority;
+    return true;
+}
+
+/**
+ * @brief Mark a product as placed, whether or not it was the current task.
+ * @return true if this was the last product of its shipment
+ */
+bool TaskScheduler::complete(int product_id)
+{
+    auto shipment = shipment_of_.find(product_id);
+    if (shipment == shipment_of_.end() || !done_.insert(product_id).second)
+        return false;
+    return --remaining_[shipment->second] == 0;
+}
+
+/**
+ * @brief Put a task that could not be served back behind its equals. After
+ * max_attempts the product is dropped and counts as done for its shipment.
+ * @return true if dropping it left nothing to do in its shipment
+ */
+bool TaskScheduler::defer(Task task)
+{
+    if (++task.attempts < max_attempts_) {
+        task.sequence = sequence_++;
+        queue_.push(task);
+        return false;
+    }
+    dropped_++;
+    return complete(task.product_id);
+}
+
+/**
+ * @brief A placed product has to be placed again (its part turned out
+ * faulty): undo complete() and run it first among its priority.
+ */
+void TaskScheduler::reopen(Task task)
+{
+    if (!done_.erase(task.product_id))
+        return;
+    ++remaining_[shipment_of_[task.product_id]];
+    task.sequence = 0;
+    queue_.push(task);
+}
+
+/// Tasks of one priority still waiting, in the order they would run
+std::vector<Task> TaskScheduler::pendingTasks(int priority) const
+{
+    std::vector<Task> tasks;
+    auto queue = queue_;
+    for (; !queue.empty(); queue.pop())
+        if (queue.top().priority == priority && !done_.count(queue.top().product_id))
+            tasks.push_back(queue.top());
+    return tasks;
+}
+
+/// The next @p count tasks next() would return, if nothing is added meanwhile
+std::vector<Task> TaskScheduler::upcoming(int count) const
+{
+    std::vector<Task> tasks;
+    auto queue = queue_;
+    for (; !queue.empty() && int(tasks.size()) < count; queue.pop())
+        if (!done_.count(queue.top().product_id))
+            tasks.push_back(queue.top());
+    return tasks;
+}
+
+/**
+ * @brief Run the listed products in the given order. They keep their
+ * priority, and take the sequence slots they already held between them, so
+ * tasks that are not listed do not move.
+ */
+void TaskScheduler::reorder(const std::vector<int> &product_ids)
+{
+    std::unordered_map<int, size_t> position;
+    for (size_t i = 0; i < product_ids.size(); i++)
+        position[product_ids[i]] = i;
+
+    std::vector<Task> listed, others;
+    for (; !queue_.empty(); queue_.pop())
+        (position.count(queue_.top().product_id) ? listed : others).push_back(queue_.top());
+
+    std::vector<unsigned long> slots;
+    for (auto &task : listed)
+        slots.push_back(task.sequence);
+    std::sort(slots.begin(), slots.end());
+    std::sort(listed.begin(), listed.end(), [&position](const Task &a, const Task &b) {
+        return position[a.product_id] < position[b.product_id];
+    });
+    for (size_t i = 0; i < listed.size(); i++) {
+        listed[i].sequence = slots[i];
+        queue_.push(listed[i]);
+    }
+    for (auto &task : others)
+        queue_.push(task);
+}
+
+void TaskScheduler::skipDone()
+{
+    while (!queue_.empty() && done_.count(queue_.top().product_id))
+        queue_.pop();
+}
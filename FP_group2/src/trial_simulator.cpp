@@ -0,0 +1,653 @@
+#include "trial_simulator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+
+#include <yaml-cpp/yaml.h>
+
+#include "executive_policy.h"
+
+namespace {
+
+/// Numeric or 'pi'-style YAML angle, only used to tell a flipped part
+bool isNonZero(const YAML::Node &value)
+{
+    std::string text = value.as<std::string>();
+    try {
+        return std::fabs(std::stod(text)) > 1e-6;
+    } catch (const std::exception &) {
+        return true; // 'pi', '-pi/4', ...
+    }
+}
+
+/// Parts of a models_over_bins / models_over_shelves grid, offsets from the container origin
+std::vector<point2> grid(const YAML::Node &model)
+{
+    int nx = model["num_models_x"] ? model["num_models_x"].as<int>() : 1;
+    int ny = model["num_models_y"] ? model["num_models_y"].as<int>() : 1;
+    auto start = model["xyz_start"], end = model["xyz_end"];
+    std::vector<point2> offsets;
+    for (int ix = 0; ix < nx; ix++)
+        for (int iy = 0; iy < ny; iy++) {
+            double fx = nx > 1 ? double(ix) / (nx - 1) : 0.0, fy = ny > 1 ? double(iy) / (ny - 1) : 0.0;
+            offsets.push_back({start[0].as<double>() + fx * (end[0].as<double>() - start[0].as<double>()),
+                               start[1].as<double>() + fy * (end[1].as<double>() - start[1].as<double>())});
+        }
+    return offsets;
+}
+
+/// Trailing number of a key like "order_3" or "bin12"
+int keyIndex(const std::string &key)
+{
+    auto digits = key.find_last_not_of("0123456789");
+    return digits + 1 < key.size() ? std::atoi(key.c_str() + digits + 1) : 0;
+}
+
+double mean(const std::vector<double> &values)
+{
+    double sum = 0.0;
+    for (auto value : values)
+        sum += value;
+    return values.empty() ? 0.0 : sum / values.size();
+}
+
+}
+
+TrialSimulator::TrialSimulator(unsigned seed, bool old_loop):
+        random_(seed), old_loop_(old_loop), time_limit_(-1.0), belt_cycles_(0), sequencer_(selector_), interceptor_(SIM_BELT_SPEED)
+{
+}
+
+/**
+ * @brief Read a trial configuration (the YAML given to the ARIAC launch).
+ * @return false if the file cannot be parsed
+ */
+bool TrialSimulator::load(const std::string &path)
+{
+    YAML::Node trial;
+    try {
+        trial = YAML::LoadFile(path);
+    } catch (const YAML::Exception &error) {
+        std::cerr << "[TrialSimulator::load] " << path << ": " << error.what() << std::endl;
+        return false;
+    }
+
+    time_limit_ = trial["time_limit"] ? trial["time_limit"].as<double>() : -1.0;
+    std::map<std::string, std::string> aliases;
+    if (auto options = trial["options"]) {
+        if (options["belt_population_cycles"])
+            belt_cycles_ = options["belt_population_cycles"].as<int>();
+        for (auto alias : options["model_type_aliases"])
+            aliases[alias.first.as<std::string>()] = alias.second.as<std::string>();
+    }
+    auto resolve = [&aliases](const std::string &type) {
+        return aliases.count(type) ? aliases[type] : type;
+    };
+
+    // shelves 3..11 are numbered row by row, a 0 in the layout is a gap
+    std::map<int, point2> shelves = {{1, SIM_SHELF1_POSITION}, {2, SIM_SHELF2_POSITION}};
+    int shelf = 3;
+    for (int row = 0; row < int(SIM_SHELF_ROW_Y.size()); row++) {
+        auto layout = trial["shelf_layout"]["row_" + std::to_string(row + 1)];
+        for (int column = 0; column < int(layout.size()) && column < int(SIM_SHELF_SLOT_X.size()); column++)
+            if (layout[column].as<std::string>() != "0")
+                shelves[shelf++] = {SIM_SHELF_SLOT_X[column], SIM_SHELF_ROW_Y[row]};
+    }
+
+    for (auto person : trial["aisle_layout"])
+        people_.push_back({person.second["location"].as<double>(), person.second["start_time"].as<double>(),
+                           person.second["move_time"].as<double>(), person.second["wait_time"].as<double>()});
+
+    for (auto name : trial["faulty_products"])
+        faulty_names_.push_back(name.as<std::string>());
+
+    std::map<int, SimOrder> orders;
+    for (auto entry : trial["orders"]) {
+        auto node = entry.second;
+        SimOrder order;
+        order.condition = node["announcement_condition"] ? node["announcement_condition"].as<std::string>() : "time";
+        order.value = node["announcement_condition_value"] ? node["announcement_condition_value"].as<double>() : 0.0;
+        order.shipment_count = node["shipment_count"] ? node["shipment_count"].as<int>() : 1;
+        for (auto destination : node["destinations"])
+            order.destinations.push_back(destination.as<std::string>());
+        for (auto product : node["products"])
+            order.products.push_back({resolve(product.second["type"].as<std::string>()),
+                                      isNonZero(product.second["pose"]["rpy"][0])});
+        order.announced = false;
+        order.announced_at = order.completed_at = -1.0;
+        orders[keyIndex(entry.first.as<std::string>())] = order;
+    }
+    for (auto &order : orders)
+        orders_.push_back(order.second);
+
+    // spawned models are named <type>_<n>, bins first, then shelves, then the belt
+    auto spawn = [this](const std::string &type, point2 position, int camera) {
+        std::string name = type + "_" + std::to_string(++spawned_[type]);
+        bool faulty = std::find(faulty_names_.begin(), faulty_names_.end(), name) != faulty_names_.end();
+        initial_parts_.push_back({type, name, position, camera, faulty, false});
+    };
+    for (auto bin : trial["models_over_bins"]) {
+        int number = keyIndex(bin.first.as<std::string>());
+        if (number < 1 || number > NUMBER_OF_BINS)
+            continue;
+        auto &slot = staging_.slot(number);
+        for (auto model : bin.second["models"])
+            for (auto offset : grid(model.second))
+                spawn(resolve(model.first.as<std::string>()),
+                      {slot.center.x + offset.x - BIN_HALF_WIDTH_X, slot.center.y + offset.y - BIN_HALF_WIDTH_Y},
+                      slot.camera);
+    }
+    for (auto entry : trial["models_over_shelves"]) {
+        int number = keyIndex(entry.first.as<std::string>());
+        if (!shelves.count(number))
+            continue;
+        for (auto model : entry.second["models"])
+            for (auto offset : grid(model.second))
+                spawn(resolve(model.first.as<std::string>()),
+                      {shelves[number].x + offset.x - 0.5, shelves[number].y}, SIM_SHELF_CAMERA + number);
+    }
+    initial_spawned_ = spawned_;
+
+    for (auto model : trial["belt_models"])
+        for (auto spawn_time : model.second)
+            belt_models_.push_back({resolve(model.first.as<std::string>()), spawn_time.first.as<double>()});
+    return true;
+}
+
+void TrialSimulator::reset()
+{
+    clock_ = 0.0;
+    gantry_ = SIM_START_POSITION;
+    waiting_at_ = -1;
+    wanted_ = unwanted_ = 0;
+    parts_ = initial_parts_;
+    spawned_ = initial_spawned_;
+    belt_.clear();
+    products_.clear();
+    submitted_.clear();
+    for (auto &order : orders_) {
+        order.announced = false;
+        order.announced_at = order.completed_at = -1.0;
+    }
+    events_ = decltype(events_)();
+    for (int i = 0; i < int(orders_.size()); i++)
+        if (orders_[i].condition == "time")
+            events_.push({orders_[i].value, EVENT_ORDER, i});
+    for (int cycle = 0; cycle < belt_cycles_; cycle++)
+        for (int i = 0; i < int(belt_models_.size()); i++)
+            events_.push({belt_models_[i].second + cycle * SIM_BELT_CYCLE, EVENT_BELT, i});
+
+    scheduler_ = TaskScheduler(old_loop_ ? 1 : MAX_TASK_ATTEMPTS);
+    selector_ = PartSelector();
+    interceptor_ = BeltInterceptor(SIM_BELT_SPEED);
+    staging_ = StagingBuffer();
+    predictor_ = RegionPredictor();
+    metrics_ = SimMetrics();
+}
+
+/**
+ * @brief Run the trial once, from the first order to the last shipment or
+ * the time limit.
+ */
+SimMetrics TrialSimulator::run()
+{
+    reset();
+    advance(0.0);
+
+    Task task;
+    while (scheduler_.next(task)) {
+        if (time_limit_ > 0 && clock_ > time_limit_)
+            break;
+        double started = clock_;
+        SimProduct &product = products_[task.product_id];
+
+        interceptBelt(task);
+        bool placed = product.placed;
+        while (!placed) {
+            std::vector<Candidate> candidates;
+            for (int p = 0; p < int(parts_.size()); p++)
+                if (!parts_[p].used && parts_[p].type == product.type)
+                    candidates.push_back({parts_[p].camera, p, parts_[p].position, 0.0});
+            if (candidates.empty())
+                break;
+            selector_.rank(candidates, gantry_, agvPosition(agvOf(product)), humans());
+            SimPart &part = parts_[candidates.front().slot];
+
+            bool over_bins = waiting_at_ >= 0;
+            predictor_.record(waiting_at_, part.camera);
+            waiting_at_ = -1;
+            if (ExecutivePolicy::routeViaStart(part.camera, over_bins, false))
+                travel(SIM_START_POSITION);
+            travel(part.position);
+            bool held = false;
+            for (int attempt = 0; attempt < SIM_PICKING_ATTEMPTS && !held; attempt++) {
+                metrics_.picks++;
+                clock_ += SIM_PICK_TIME;
+                held = std::uniform_real_distribution<double>(0.0, 1.0)(random_) < SIM_PICK_SUCCESS;
+                metrics_.failed_picks += !held;
+            }
+            // like the executive, a part that would not attach is not tried again
+            part.used = true;
+            if (!held)
+                continue;
+            travel(SIM_START_POSITION);
+            placed = placeProduct(task, part.faulty);
+        }
+
+        if (placed)
+            metrics_.cycle_times.push_back(clock_ - started);
+        else if (scheduler_.defer(task))
+            submitShipment(task);
+        advance(clock_);
+        if (placed)
+            prePosition();
+    }
+
+    metrics_.makespan = clock_;
+    metrics_.dropped = scheduler_.dropped();
+    metrics_.products = products_.size();
+    for (int o = 0; o < int(orders_.size()); o++) {
+        auto &order = orders_[o];
+        double priority = o > 0 ? 3.0 : 1.0; // later orders interrupt the first one
+        int count = order.products.size();
+        metrics_.max_score += priority * order.shipment_count * 3 * count;
+        if (order.completed_at >= 0.0)
+            metrics_.order_times.push_back(order.completed_at - order.announced_at);
+        for (int s = 0; s < order.shipment_count; s++) {
+            auto submitted = submitted_.find({o, s});
+            if (submitted == submitted_.end() || (time_limit_ > 0 && submitted->second > time_limit_))
+                continue;
+            int placed = 0;
+            for (auto &product : products_)
+                placed += product.order == o && product.shipment == s && product.placed;
+            metrics_.score += priority * (2 * placed + (placed == count ? count : 0)); // type + pose, all-products bonus
+        }
+    }
+    return metrics_;
+}
+
+/// Process the trial events up to @p time and announce orders whose condition is met
+void TrialSimulator::advance(double time)
+{
+    clock_ = std::max(clock_, time);
+    while (!events_.empty() && events_.top().time <= clock_) {
+        Event next = events_.top();
+        events_.pop();
+        if (next.kind == EVENT_BELT) {
+            auto &model = belt_models_[next.index];
+            std::string name = model.first + "_" + std::to_string(++spawned_[model.first]);
+            bool faulty = std::find(faulty_names_.begin(), faulty_names_.end(), name) != faulty_names_.end();
+            belt_.push_back({model.first, name, next.time, faulty, false});
+        } else if (!orders_[next.index].announced) {
+            orders_[next.index].announced = true;
+            orders_[next.index].announced_at = next.time;
+            addShipments(next.index);
+        }
+    }
+    announceOrders();
+}
+
+/// Orders announced after a number of wanted or unwanted products were placed
+void TrialSimulator::announceOrders()
+{
+    for (int i = 0; i < int(orders_.size()); i++) {
+        auto &order = orders_[i];
+        if (order.announced)
+            continue;
+        if ((order.condition == "wanted_products" && wanted_ >= order.value)
+            || (order.condition == "unwanted_products" && unwantedFor(order) >= order.value)) {
+            order.announced = true;
+            order.announced_at = clock_;
+            addShipments(i);
+        }
+    }
+}
+
+/**
+ * @brief Products on the trays that @p order has no use for: placed products
+ * of a type it does not ask for (or more of a type than it asks for), plus
+ * every faulty part placed so far.
+ */
+int TrialSimulator::unwantedFor(const SimOrder &order) const
+{
+    std::map<std::string, int> wanted;
+    for (auto &product : order.products)
+        wanted[product.first] += order.shipment_count;
+    int unwanted = unwanted_;
+    for (auto &product : products_)
+        if (product.placed && --wanted[product.type] < 0)
+            unwanted++;
+    return unwanted;
+}
+
+/// Queue and sequence the shipments of a new order, like the executive does
+void TrialSimulator::addShipments(int order)
+{
+    auto &announced = orders_[order];
+    for (int s = 0; s < announced.shipment_count; s++) {
+        int first = products_.size();
+        std::string agv = s < int(announced.destinations.size()) ? announced.destinations[s] : "any";
+        for (auto &product : announced.products)
+            products_.push_back({order, s, product.first, agv, product.second, false, -1.0});
+        scheduler_.addShipment(order, s, first, announced.products.size(), order);
+    }
+    if (old_loop_)
+        return;
+
+    std::vector<Visit> visits;
+    std::vector<bool> claimed(parts_.size(), false);
+    for (auto &task : scheduler_.pendingTasks(order)) {
+        auto &product = products_[task.product_id];
+        int best = -1;
+        for (int p = 0; p < int(parts_.size()); p++)
+            if (!parts_[p].used && !claimed[p] && parts_[p].type == product.type
+                && (best < 0 || PartSelector::legTime(gantry_, parts_[p].position)
+                                < PartSelector::legTime(gantry_, parts_[best].position)))
+                best = p;
+        if (best < 0)
+            continue;
+        claimed[best] = true;
+        visits.push_back({task.product_id, parts_[best].position, agvPosition(agvOf(product))});
+    }
+    if (visits.size() > 1)
+        scheduler_.reorder(sequencer_.sequence(visits, gantry_, humans()));
+}
+
+/// Move the gantry, waiting for people in the aisles it goes through
+double TrialSimulator::travel(point2 to)
+{
+    std::array<int, 4> clear = {0, 0, 0, 0};
+    double time = selector_.travelTime(gantry_, to, clear);
+    double wait = 0.0;
+    for (auto aisle : {PartSelector::aisleOf(gantry_), PartSelector::aisleOf(to)})
+        if (aisle >= 0)
+            wait += aisleDelay(aisle, clock_ + wait);
+    clock_ += time + wait;
+    metrics_.travel_time += time;
+    metrics_.aisle_wait += wait;
+    gantry_ = to;
+    return time + wait;
+}
+
+/// Time until nobody walks in @p aisle, people only block it while moving
+double TrialSimulator::aisleDelay(int aisle, double time) const
+{
+    double delay = 0.0;
+    for (auto &person : people_) {
+        if (std::fabs(person.location - AISLE_Y[aisle]) > 0.1 || time < person.start_time)
+            continue;
+        double period = 2.0 * (person.move_time + person.wait_time);
+        double phase = std::fmod(time - person.start_time, period);
+        double half = person.move_time + person.wait_time;
+        double in_half = phase < half ? phase : phase - half;
+        if (in_half < person.move_time)
+            delay = std::max(delay, person.move_time - in_half);
+    }
+    return delay;
+}
+
+/// Aisles with someone in them, what HumanDetection reports at startup
+std::array<int, 4> TrialSimulator::humans() const
+{
+    std::array<int, 4> human = {0, 0, 0, 0};
+    for (auto &person : people_)
+        for (int aisle = 0; aisle < int(AISLE_Y.size()); aisle++)
+            if (std::fabs(person.location - AISLE_Y[aisle]) < 0.1)
+                human[aisle] = 1;
+    return human;
+}
+
+std::string TrialSimulator::agvOf(const SimProduct &product) const
+{
+    return ExecutivePolicy::assignedAgv(product.agv, product.shipment);
+}
+
+point2 TrialSimulator::agvPosition(const std::string &agv) const
+{
+    return agv == "agv1" ? AGV1_POSITION : AGV2_POSITION;
+}
+
+/**
+ * @brief Place the held part for @p task on its tray and wait for the quality
+ * sensor. A faulty part is taken off again.
+ * @return true if the product is done
+ */
+bool TrialSimulator::placeProduct(const Task &task, bool faulty)
+{
+    SimProduct &product = products_[task.product_id];
+    travel(agvPosition(agvOf(product)));
+    if (product.flip)
+        clock_ += SIM_FLIP_TIME;
+    clock_ += SIM_PLACE_TIME + SIM_QC_TIME;
+    if (faulty) {
+        unwanted_++;
+        metrics_.faulty_replaced++;
+        clock_ += SIM_DISPOSE_TIME;
+        travel(SIM_START_POSITION);
+        return false;
+    }
+
+    product.placed = true;
+    product.placed_at = clock_;
+    wanted_++;
+    metrics_.placed++;
+    if (scheduler_.complete(task.product_id))
+        submitShipment(task);
+    return true;
+}
+
+/// The last product of the shipment of @p task is placed or given up
+void TrialSimulator::submitShipment(const Task &task)
+{
+    submitted_[{task.order, task.shipment}] = clock_;
+    auto &order = orders_[task.order];
+    bool order_done = true;
+    for (int s = 0; s < order.shipment_count; s++)
+        order_done &= submitted_.count({task.order, s}) > 0;
+    if (order_done)
+        order.completed_at = clock_;
+}
+
+double TrialSimulator::beltY(const SimBeltPart &part, double time) const
+{
+    return SIM_BELT_SPAWN_Y + BELT_DIRECTION_Y * SIM_BELT_SPEED * (time - part.spawned);
+}
+
+/// Gantry y of GantryControl::beltStation, as a world y
+double TrialSimulator::stationY(const std::string &type) const
+{
+    if (type.find("piston_rod_part") == 0)
+        return 1.5;
+    if (type.find("disk_part") == 0 || type.find("gasket_part") == 0)
+        return 1.7;
+    return 1.9;
+}
+
+/// More products of this type wanted than parts of it in the bins and shelves
+bool TrialSimulator::beltNeeded(const std::string &type) const
+{
+    int wanted = 0, stock = 0;
+    for (auto &product : products_)
+        wanted += !product.placed && product.type == type;
+    for (auto &part : parts_)
+        stock += !part.used && part.type == type;
+    return wanted > stock;
+}
+
+/**
+ * @brief A needed belt part that camera 12 has seen, that is still on the belt
+ * and whose sighting the interceptor has not used up yet, -1 if none
+ */
+int TrialSimulator::beltSighted() const
+{
+    for (int b = 0; b < int(belt_.size()); b++) {
+        double y = beltY(belt_[b], clock_);
+        if (!belt_[b].taken && y <= SIM_CAMERA_12_Y && y > SIM_BELT_END_Y && beltNeeded(belt_[b].type)
+            && interceptor_.isNew(sightingOf(belt_[b])))
+            return b;
+    }
+    return -1;
+}
+
+/// What camera 12 reported when @p part passed it
+BeltSighting TrialSimulator::sightingOf(const SimBeltPart &part) const
+{
+    double to_camera = (SIM_BELT_SPAWN_Y - SIM_CAMERA_12_Y) / SIM_BELT_SPEED;
+    return {part.type, SIM_CAMERA_12_Y, part.spawned + to_camera};
+}
+
+/// Time the next part of @p type reaches camera 12, -1 if none is coming
+int TrialSimulator::nextBeltPart(const std::string &type) const
+{
+    double best = -1.0;
+    double to_camera = (SIM_BELT_SPAWN_Y - SIM_CAMERA_12_Y) / SIM_BELT_SPEED;
+    for (auto &part : belt_)
+        if (!part.taken && part.type == type && part.spawned + to_camera >= clock_
+            && (best < 0 || part.spawned + to_camera < best))
+            best = part.spawned + to_camera;
+    auto pending = events_;
+    for (; !pending.empty(); pending.pop())
+        if (pending.top().kind == EVENT_BELT && belt_models_[pending.top().index].first == type) {
+            double seen = pending.top().time + to_camera;
+            if (best < 0 || seen < best)
+                best = seen;
+            break;
+        }
+    return best < 0 ? -1 : int(std::ceil(best));
+}
+
+/**
+ * @brief Belt handling at the start of a task: wait (bounded) for the part of
+ * a product only the belt can serve, then intercept a sighted part and either
+ * place it for the current product or stage it.
+ */
+void TrialSimulator::interceptBelt(const Task &task)
+{
+    SimProduct &product = products_[task.product_id];
+    bool in_stock = false;
+    for (auto &part : parts_)
+        in_stock |= !part.used && part.type == product.type;
+    if (!in_stock && beltSighted() < 0) {
+        int seen = nextBeltPart(product.type);
+        if (seen >= 0 && seen - clock_ <= BELT_WAIT_TIMEOUT) {
+            metrics_.belt_wait += seen - clock_;
+            advance(seen);
+        }
+    }
+
+    int b = beltSighted();
+    if (b < 0)
+        return;
+    SimBeltPart &part = belt_[b];
+    BeltSighting sighting = sightingOf(part);
+    point2 station = {SIM_BELT_X, stationY(part.type)};
+    Intercept intercept = interceptor_.plan(sighting, station, clock_, gantry_);
+    if (!intercept.feasible) {
+        // out of reach before BELT_LAST_GRASP_Y, it stays on the belt but its sighting is used up
+        interceptor_.record(sighting, intercept, false);
+        metrics_.belt_missed++;
+        return;
+    }
+    station.y = intercept.y - BELT_GRASP_OFFSET_Y;
+
+    waiting_at_ = -1;
+    travel(station);
+    clock_ += BELT_STATION_SETTLE_TIME;
+    if (intercept.arrival_time > clock_) {
+        metrics_.belt_wait += intercept.arrival_time - clock_;
+        clock_ = intercept.arrival_time;
+    }
+    part.taken = true;
+    bool grasped = std::uniform_real_distribution<double>(0.0, 1.0)(random_) < SIM_BELT_GRASP_SUCCESS;
+    interceptor_.record(sighting, intercept, grasped);
+    if (!grasped) {
+        metrics_.belt_missed++;
+        return;
+    }
+    metrics_.belt_grasped++;
+
+    point2 agv = agvPosition(agvOf(product));
+    if (ExecutivePolicy::placeDirectly(part.type, product.type, product.placed, true, station, agv)) {
+        metrics_.belt_direct++;
+        travel(SIM_START_POSITION);
+        placeProduct(task, part.faulty);
+        return;
+    }
+
+    std::vector<point2> inventory;
+    for (auto &stored : parts_)
+        if (!stored.used && stored.camera < NUMBER_OF_BIN_CAMERAS)
+            inventory.push_back(stored.position);
+    int bin = ExecutivePolicy::stagingBin(staging_.reserve(agv, inventory));
+    travel(SIM_START_POSITION);
+    travel(staging_.slot(bin).center);
+    clock_ += SIM_PLACE_TIME;
+    parts_.push_back({part.type, part.name, staging_.slot(bin).center, staging_.slot(bin).camera, part.faulty, false});
+    metrics_.belt_staged++;
+}
+
+/// Wait over the bins the next products are likely in, see RegionPredictor
+void TrialSimulator::prePosition()
+{
+    const std::array<point2, NUMBER_OF_BIN_CAMERAS> stations = {{{5.0, 1.75}, {3.082, 1.75}, {3.082, -1.75},
+                                                                 {5.0, -1.75}}};
+    std::vector<std::vector<int>> cameras;
+    for (auto &task : scheduler_.upcoming(REGION_LOOKAHEAD)) {
+        cameras.emplace_back();
+        for (auto &part : parts_)
+            if (!part.used && part.type == products_[task.product_id].type
+                && std::find(cameras.back().begin(), cameras.back().end(), part.camera) == cameras.back().end())
+                cameras.back().push_back(part.camera);
+    }
+    int camera = predictor_.predict(cameras);
+    if (camera < 0)
+        return;
+    travel(stations[camera]);
+    waiting_at_ = camera;
+}
+
+/**
+ * @brief Mean of every metric over several runs, score first.
+ */
+void TrialSimulator::printReport(const std::vector<SimMetrics> &runs)
+{
+    if (runs.empty())
+        return;
+    auto average = [&runs](double (*field)(const SimMetrics &)) {
+        double sum = 0.0;
+        for (auto &run : runs)
+            sum += field(run);
+        return sum / runs.size();
+    };
+    std::vector<double> cycles, orders;
+    for (auto &run : runs) {
+        cycles.insert(cycles.end(), run.cycle_times.begin(), run.cycle_times.end());
+        orders.insert(orders.end(), run.order_times.begin(), run.order_times.end());
+    }
+    std::sort(cycles.begin(), cycles.end());
+
+    std::printf("runs                 %zu\n", runs.size());
+    std::printf("score                %.1f / %.1f\n", average([](const SimMetrics &m) { return m.score; }),
+                runs.front().max_score);
+    std::printf("makespan             %.1f s\n", average([](const SimMetrics &m) { return m.makespan; }));
+    std::printf("products placed      %.1f / %d, %.1f dropped\n",
+                average([](const SimMetrics &m) { return double(m.placed); }), runs.front().products,
+                average([](const SimMetrics &m) { return double(m.dropped); }));
+    std::printf("picks                %.1f, %.1f failed\n", average([](const SimMetrics &m) { return double(m.picks); }),
+                average([](const SimMetrics &m) { return double(m.failed_picks); }));
+    std::printf("faulty replaced      %.1f\n", average([](const SimMetrics &m) { return double(m.faulty_replaced); }));
+    std::printf("belt                 %.1f grasped, %.1f missed, %.1f direct, %.1f staged\n",
+                average([](const SimMetrics &m) { return double(m.belt_grasped); }),
+                average([](const SimMetrics &m) { return double(m.belt_missed); }),
+                average([](const SimMetrics &m) { return double(m.belt_direct); }),
+                average([](const SimMetrics &m) { return double(m.belt_staged); }));
+    std::printf("travel               %.1f s, %.1f s waiting in aisles, %.1f s waiting for the belt\n",
+                average([](const SimMetrics &m) { return m.travel_time; }),
+                average([](const SimMetrics &m) { return m.aisle_wait; }),
+                average([](const SimMetrics &m) { return m.belt_wait; }));
+    std::printf("product cycle time   mean %.1f s, median %.1f s, max %.1f s\n", mean(cycles),
+                cycles.empty() ? 0.0 : cycles[cycles.size() / 2], cycles.empty() ? 0.0 : cycles.back());
+    std::printf("order completion     mean %.1f s after announcement\n", mean(orders));
+}
@@ -1,5 +1,8 @@
 #include "utils.h"
 
+std::string move_status_name[] = {"success", "out of joint bounds", "self collision", "known infeasible",
+                                  "planning failed", "execution failed"};
+
 std::unordered_map<std::string, double> model_height = {
         {"piston_rod_part_red", 0.0065}, // modified because it sinks into the surface a bit
         {"piston_rod_part_green", 0.0065},
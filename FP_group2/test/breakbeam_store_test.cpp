@@ -0,0 +1,133 @@
+/**
+ * @file breakbeam_store_test.cpp
+ * @brief BreakbeamStore under several writer threads, meant to run with
+ * -fsanitize=thread: every snapshot() must be one consistent update state.
+ */
+#include <atomic>
+#include <functional>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "breakbeam_store.h"
+
+namespace {
+
+const int WRITERS = 4;
+const int UPDATES = 20000; // per beam
+const int SHARED_BEAM = NUMBER_OF_BREAKBEAMS - 1;
+
+/**
+ * Writer w owns the beams b % WRITERS == w (but SHARED_BEAM) and toggles them:
+ * update i sets the beam on for even i, with sequence and stamp i + 1. So the
+ * k-th rising edge is stamped 2k - 1 and the k-th falling edge 2k.
+ */
+void toggleOwnBeams(BreakbeamStore &store, int writer)
+{
+    for (int i = 0; i < UPDATES; i++)
+        for (int beam = writer; beam < SHARED_BEAM; beam += WRITERS)
+            store.update(beam, i % 2 == 0, i + 1, i + 1);
+}
+
+/// Check one snapshot, false on the first inconsistency
+::testing::AssertionResult consistent(const BeamSnapshot &snapshot)
+{
+    if (snapshot.version % 2)
+        return ::testing::AssertionFailure() << "odd version " << snapshot.version;
+    for (int beam = 0; beam < NUMBER_OF_BREAKBEAMS; beam++) {
+        uint32_t rising = snapshot.rising[beam], falling = snapshot.falling[beam];
+        if (rising - falling != uint32_t(snapshot.detected(beam)))
+            return ::testing::AssertionFailure() << "beam " << beam << ": " << rising << " rising, " << falling
+                                                 << " falling, state " << snapshot.detected(beam);
+        if (beam == SHARED_BEAM)
+            continue;
+        if (rising + falling != snapshot.sequence[beam])
+            return ::testing::AssertionFailure() << "beam " << beam << ": " << rising + falling
+                                                 << " edges at sequence " << snapshot.sequence[beam];
+        if (snapshot.last_rising[beam] != (rising ? 2 * rising - 1 : 0)
+            || snapshot.last_falling[beam] != 2 * falling)
+            return ::testing::AssertionFailure() << "beam " << beam << ": stamps " << snapshot.last_rising[beam]
+                                                 << "/" << snapshot.last_falling[beam] << " after " << rising
+                                                 << "/" << falling << " edges";
+    }
+    return ::testing::AssertionSuccess();
+}
+
+}
+
+TEST(BreakbeamStore, SnapshotsStayConsistentUnderConcurrentWriters)
+{
+    BreakbeamStore store;
+    std::atomic<bool> done(false);
+    std::atomic<long> shared_edges(0);
+
+    std::vector<std::thread> writers;
+    for (int writer = 0; writer < WRITERS; writer++)
+        writers.emplace_back(toggleOwnBeams, std::ref(store), writer);
+    // every writer also hammers one beam, whatever order the updates land in
+    for (int writer = 0; writer < WRITERS; writer++)
+        writers.emplace_back([&store, &shared_edges, writer]() {
+            for (int i = 0; i < UPDATES; i++)
+                shared_edges += store.update(SHARED_BEAM, (i + writer) % 3 == 0, i + 1, i + 1) != 0;
+        });
+
+    long snapshots = 0;
+    std::thread reader([&]() {
+        uint64_t last_version = 0;
+        while (!done) {
+            auto snapshot = store.snapshot();
+            ASSERT_TRUE(consistent(snapshot));
+            ASSERT_GE(snapshot.version, last_version);
+            last_version = snapshot.version;
+            snapshots++;
+        }
+    });
+
+    for (auto &writer : writers)
+        writer.join();
+    done = true;
+    reader.join();
+    EXPECT_GT(snapshots, 0);
+
+    auto final_state = store.snapshot();
+    EXPECT_TRUE(consistent(final_state));
+    long beams = SHARED_BEAM;
+    EXPECT_EQ(final_state.version, 2u * (long(UPDATES) * beams + long(UPDATES) * WRITERS));
+    for (int beam = 0; beam < SHARED_BEAM; beam++) {
+        EXPECT_EQ(final_state.sequence[beam], uint32_t(UPDATES));
+        EXPECT_EQ(store.edges(beam, BEAM_ANY), uint32_t(UPDATES));
+    }
+    EXPECT_EQ(store.edges(SHARED_BEAM, BEAM_ANY), uint32_t(shared_edges));
+}
+
+TEST(BreakbeamStore, SingleValueReadersSeeOnlyWrittenValues)
+{
+    BreakbeamStore store;
+    std::atomic<bool> done(false);
+    std::thread writer([&store, &done]() {
+        for (int i = 0; i < UPDATES; i++)
+            store.update(0, i % 2 == 0, i + 1, i + 1);
+        done = true;
+    });
+    uint32_t last_sequence = 0;
+    uint64_t last_rising = 0;
+    bool monotonic = true;
+    while (!done) {
+        uint32_t sequence = store.sequence(0);
+        uint64_t rising = store.lastRising(0);
+        monotonic &= sequence >= last_sequence && rising >= last_rising && (rising == 0 || rising % 2 == 1);
+        last_sequence = sequence;
+        last_rising = rising;
+    }
+    writer.join();
+    EXPECT_TRUE(monotonic);
+    EXPECT_FALSE(store.detected(0));
+    EXPECT_EQ(store.lastFalling(0), uint64_t(UPDATES));
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}